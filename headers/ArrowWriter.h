@@ -0,0 +1,39 @@
+#ifndef ARROWWRITER_H
+#define ARROWWRITER_H
+
+#include "Types.h"
+#include "BaseWriter.h"
+#include "OutputFile.h"
+
+// Writes the Arrow IPC streaming format (a schema message, record batches, end-of-stream
+// marker) without depending on the Arrow libraries. Columns are typed: float64 coordinates,
+// volume and gap, a boolean intersection status and an int8 intersection type. Values are
+// written at full double precision; the precision setting only applies to text formats.
+class ArrowWriter : public BaseWriter {
+public:
+    static constexpr size_t DEFAULT_BATCH_SIZE = 65536;
+
+    ArrowWriter(const std::string& filename, size_t batchSize = DEFAULT_BATCH_SIZE, bool includeGap = false);
+    ~ArrowWriter();
+    void writeEntry(const Tetrahedron& T1, const Tetrahedron& T2, double volume, bool intersects);
+    void writeRecord(const PairRecord& record);
+    void flush(); // ends the current batch early and releases its buffers
+    void close();
+    uint64_t bytesWritten() { return static_cast<uint64_t>(outFile.tellp()); }
+    bool checksum(uint32_t& crc, uint64_t& size) { return outFile.checksum(crc, size); }
+
+private:
+    void writeSchema();
+    void writeBatch();
+    void writeMessage(const std::vector<uint8_t>& metadata, const std::vector<uint8_t>& body);
+
+    OutputFile outFile;
+    size_t batchSize;
+    bool includeGap;
+    std::vector<std::string> doubleColumns;
+    std::vector<std::vector<double>> doubles; // coordinates, volume and optionally gap
+    std::vector<bool> status;
+    std::vector<int8_t> types;
+};
+
+#endif // ARROWWRITER_H
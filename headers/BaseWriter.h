@@ -1,16 +1,28 @@
 #pragma once
 
 #include "Types.h"
+#include "Config.h"
 
-std::string formatFilename(const std::string& extension, int numberOfEntries);
+std::string formatFilename(const std::string& extension, int numberOfEntries, const std::string& tag = "");
 
 class BaseWriter {
 public:
-    static std::unique_ptr<BaseWriter> createWriter(const std::string& type, int numberOfEntries, int prec = 6);
+    static std::unique_ptr<BaseWriter> createWriter(const std::string& type, int numberOfEntries, int prec = 6, const std::string& tag = "", bool includeGap = false, bool includeType = false);
+    static std::unique_ptr<BaseWriter> createWriter(const Configuration& config);
+    static std::unique_ptr<BaseWriter> createFileWriter(const std::string& type, const std::string& filename, int prec = 6, bool includeGap = false, bool includeType = false);
     BaseWriter() = default;
     BaseWriter(int prec) : precision(prec){};
     virtual ~BaseWriter() = default;
     virtual void writeEntry(const Tetrahedron& T1, const Tetrahedron& T2, double volume, bool intersects) = 0;
+    virtual void writeRecord(const PairRecord& record) { writeEntry(record.T1, record.T2, record.volume, record.intersects); }
+    virtual uint64_t bytesWritten() { return 0; } // bytes already handed to the file, where the format can tell
+    // CRC-32 and size of the finished file after close(), where the format can tell (OutputFile::setChecksums)
+    virtual bool checksum(uint32_t& crc, uint64_t& size) { return false; }
+    virtual void flush() {} // writes out records held in memory, called when memory runs short
+    // Completes the output (trailer, last batch, closing files) and throws if any of it failed.
+    // Owners call it before destruction; destructors only repeat it for outputs left open and
+    // report errors instead of throwing.
+    virtual void close() {}
 protected:
     int precision;
 };
@@ -3,16 +3,24 @@
 
 #include "Types.h"
 #include "BaseWriter.h"
+#include "OutputFile.h"
 
 class CSVWriter : public BaseWriter {
 public:
-    CSVWriter(const std::string& filename, int prec = 6);
+    // When appending to a file that has a header, its IntersectionType column decides includeType
+    CSVWriter(const std::string& filename, int prec = 6, bool includeGap = false, bool includeType = false, bool append = false);
     ~CSVWriter();
     void writeEntry(const Tetrahedron& T1, const Tetrahedron& T2, double volume, bool intersects);
+    void writeRecord(const PairRecord& record);
+    void close();
+    uint64_t bytesWritten() { return static_cast<uint64_t>(outFile.tellp()); }
+    bool checksum(uint32_t& crc, uint64_t& size) { return outFile.checksum(crc, size); }
 private:
-    std::ofstream outFile;
+    OutputFile outFile;
     std::vector<std::string> headers;
     std::vector<std::string> entries;
+    bool includeGap;
+    bool includeType;
     void setHeaders();
     void writeHeaders();
     void writeVertex(const Point& p);
@@ -0,0 +1,6 @@
+#pragma once
+
+#include "Types.h"
+
+// CRC-32 (IEEE 802.3, as used by gzip and zip); pass the previous value to continue a running checksum
+uint32_t crc32(uint32_t crc, const char* data, size_t length);
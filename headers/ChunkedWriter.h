@@ -0,0 +1,43 @@
+#ifndef CHUNKEDWRITER_H
+#define CHUNKEDWRITER_H
+
+#include "Types.h"
+#include "BaseWriter.h"
+
+// Splits one output into numbered chunk files that roll over after a number of rows or
+// bytes, and keeps <base>.manifest.json up to date with every completed chunk.
+class ChunkedWriter : public BaseWriter {
+public:
+    ChunkedWriter(const std::string& type, const std::string& filename, int prec, uint64_t rowsPerChunk, uint64_t bytesPerChunk, bool includeGap = false, bool includeType = false);
+    ~ChunkedWriter();
+    void writeEntry(const Tetrahedron& T1, const Tetrahedron& T2, double volume, bool intersects);
+    void writeRecord(const PairRecord& record);
+    void flush();
+    void close(); // closes the open chunk and marks the manifest complete
+
+private:
+    struct Chunk {
+        std::string filename;
+        uint64_t rows = 0;
+        uint64_t bytes = 0;
+        uint32_t crc = 0;
+        std::array<uint64_t, 5> rowsPerType{}; // intersection types 1 to 5
+    };
+
+    void openChunk();
+    void closeChunk();
+    void writeManifest() const;
+
+    std::string type;
+    std::string basename;
+    uint64_t rowsPerChunk;
+    uint64_t bytesPerChunk;
+    bool includeGap;
+    bool includeType;
+    std::unique_ptr<BaseWriter> writer;
+    Chunk current;
+    std::vector<Chunk> chunks;
+    bool complete = false;
+};
+
+#endif // CHUNKEDWRITER_H
@@ -0,0 +1,28 @@
+#ifndef COMPOSITEWRITER_H
+#define COMPOSITEWRITER_H
+
+#include "Types.h"
+#include "BaseWriter.h"
+
+// Routes every record to one split, chosen deterministically from the seed and the
+// record index, and writes it to each sink of that split. Geometry is computed once
+// no matter how many files are produced.
+class CompositeWriter : public BaseWriter {
+public:
+    CompositeWriter(uint64_t seed);
+    void addSplit(double ratio, std::vector<std::unique_ptr<BaseWriter>> sinks);
+    void writeEntry(const Tetrahedron& T1, const Tetrahedron& T2, double volume, bool intersects);
+    void writeRecord(const PairRecord& record);
+    void flush();
+    void close();
+
+private:
+    size_t selectSplit();
+
+    uint64_t seed;
+    uint64_t recordIndex = 0;
+    std::vector<double> cumulativeRatios;
+    std::vector<std::vector<std::unique_ptr<BaseWriter>>> splits;
+};
+
+#endif // COMPOSITEWRITER_H
@@ -7,22 +7,145 @@ public:
     Configuration(const std::string& config_path = "../config/config.json");
     
     std::string getOutputFormat() const { return output_format; }
+    const std::vector<std::string>& getOutputFormats() const { return output_formats; }
+    const std::vector<std::pair<std::string, double>>& getSplits() const { return splits; }
+    uint64_t getSplitSeed() const { return split_seed; }
     int getPrecision() const { return precision; }
     int getDatasetSize() const { return dataset_size; }
     const std::vector<double>& getIntersectionDistribution() const { return intersection_distribution; }
     double getMinVolume() const { return volume_min; }
     double getMaxVolume() const { return volume_max; }
     int getNumBins() const { return num_bins; }
+    unsigned int getSeed() const { return seed; }
+    bool isGridEnabled() const { return grid_enabled; }
+    int getGridBits() const { return grid_bits; }
+    const std::string& getSharedMemoryName() const { return shm_name; }
+    uint64_t getSharedMemoryCapacity() const { return shm_capacity; }
+    const std::string& getSharedMemoryMode() const { return shm_mode; }
+    double getSharedMemoryTimeout() const { return shm_timeout; }
+    bool isNearMissEnabled() const { return near_miss_enabled; }
+    double getNearMissFraction() const { return near_miss_fraction; }
+    double getNearMissGapMin() const { return near_miss_gap_min; }
+    double getNearMissGapMax() const { return near_miss_gap_max; }
+    bool isContainmentEnabled() const { return containment_enabled; }
+    double getContainmentFromVolume() const { return containment_from_volume; }
+    double getContainmentFraction() const { return containment_fraction; }
+    bool isPrefilterEnabled() const { return prefilter_enabled; }
+    const std::vector<std::string>& getPrefilterStages() const { return prefilter_stages; }
+    double getPrefilterTolerance() const { return prefilter_tolerance; }
+    bool isTypeColumnEnabled() const { return type_column || top_up_enabled; } // top-up needs exact types
+    bool isTopUpEnabled() const { return top_up_enabled; }
+    const std::string& getTopUpInput() const { return top_up_input; }
+    const std::string& getTopUpMode() const { return top_up_mode; }
+    size_t getArrowBatchSize() const { return arrow_batch_size; }
+    const std::string& getCompressionFormat() const { return compression_format; }
+    int getCompressionLevel() const { return compression_level; }
+    bool isAsyncOutputEnabled() const { return async_output_enabled; }
+    int getAsyncOutputBlockMb() const { return async_output_block_mb; }
+    int getAsyncOutputBlocks() const { return async_output_blocks; }
+    bool isAsyncOutputDirect() const { return async_output_direct; }
+    bool isStatisticsEnabled() const { return statistics_enabled; }
+    int getStatisticsHistogramBins() const { return statistics_histogram_bins; }
+    bool isLabelShortcutEnabled() const { return label_shortcut_enabled; }
+    double getLabelAuditRate() const { return label_audit_rate; }
+    bool isTimeBudgetEnabled() const { return time_budget_enabled; }
+    double getTimeBudgetSeconds() const { return time_budget_seconds; }
+    bool isMemoryMonitorEnabled() const { return memory_enabled; }
+    int getMemorySampleInterval() const { return memory_sample_interval; }
+    double getMemoryCeilingMb() const { return memory_ceiling_mb; }
+    int getParallelThreads() const { return parallel_threads; }
+    int getParallelSliceSize() const { return parallel_slice_size; }
+    bool isSceneEnabled() const { return scene_enabled; }
+    int getSceneCount() const { return scene_count; }
+    int getSceneTetrahedra() const { return scene_tetrahedra; }
+    double getSceneScale() const { return scene_scale; }
+    const std::string& getSceneNarrowPhase() const { return scene_narrow_phase; }
+    bool isServerEnabled() const { return server_enabled; }
+    const std::string& getServerSocketPath() const { return server_socket_path; }
+    int getServerBatchSize() const { return server_batch_size; }
+    uint64_t getServerMaxPairsPerClient() const { return server_max_pairs_per_client; }
+    bool isBatchGenerationEnabled() const { return batch_enabled; }
+    int getBatchSize() const { return batch_size; }
+    double getMinAbsDeterminant() const { return min_abs_determinant; }
+    bool isChunkingEnabled() const { return chunking_enabled; }
+    uint64_t getRowsPerChunk() const { return rows_per_chunk; }
+    uint64_t getBytesPerChunk() const { return bytes_per_chunk; }
+    bool isShuffleEnabled() const { return shuffle_enabled; }
+    int getShuffleBufferSize() const { return shuffle_buffer_size; }
+    unsigned int getShuffleSeed() const { return shuffle_seed; }
+
+    // Checks the generation targets; also applied to the overrides of server requests
+    static void validateTargets(const std::vector<double>& distribution, double volume_min, double volume_max, int num_bins);
 
 private:
     void loadConfig(const std::string& config_path);
     void validateConfig();
 
     std::string output_format;
+    std::vector<std::string> output_formats;
+    std::vector<std::pair<std::string, double>> splits;
+    uint64_t split_seed = 0;
     int precision;
     int dataset_size;
     std::vector<double> intersection_distribution;
     double volume_min;
     double volume_max;
     int num_bins;
+    unsigned int seed = 0;
+    bool grid_enabled = false;
+    int grid_bits = 16;
+    std::string shm_name = "/tetrahedron_pairs";
+    uint64_t shm_capacity = 65536;
+    std::string shm_mode = "blocking";
+    double shm_timeout = 30.0;
+    bool near_miss_enabled = false;
+    double near_miss_fraction = 1.0;
+    double near_miss_gap_min = 0.001;
+    double near_miss_gap_max = 0.05;
+    bool containment_enabled = false;
+    double containment_from_volume = 0.0;
+    double containment_fraction = 0.5;
+    bool prefilter_enabled = false;
+    std::vector<std::string> prefilter_stages = {"volume", "bbox"};
+    double prefilter_tolerance = 1e-9;
+    bool type_column = false;
+    bool top_up_enabled = false;
+    std::string top_up_input;
+    std::string top_up_mode = "new";
+    size_t arrow_batch_size = 65536;
+    std::string compression_format = "none";
+    int compression_level = 6;
+    bool async_output_enabled = false;
+    int async_output_block_mb = 4;
+    int async_output_blocks = 4;
+    bool async_output_direct = false;
+    bool statistics_enabled = true;
+    int statistics_histogram_bins = 1000;
+    bool label_shortcut_enabled = false;
+    double label_audit_rate = 0.01;
+    bool time_budget_enabled = false;
+    double time_budget_seconds = 3600.0;
+    bool memory_enabled = false;
+    int memory_sample_interval = 1000;
+    double memory_ceiling_mb = 0.0;
+    int parallel_threads = 1;
+    int parallel_slice_size = 64;
+    bool scene_enabled = false;
+    int scene_count = 1;
+    int scene_tetrahedra = 10000;
+    double scene_scale = 0.05;
+    std::string scene_narrow_phase = "exact";
+    bool server_enabled = false;
+    std::string server_socket_path = "/tmp/tetrahedron_pairs.sock";
+    int server_batch_size = 1024;
+    uint64_t server_max_pairs_per_client = 0;
+    bool batch_enabled = false;
+    int batch_size = 1024;
+    double min_abs_determinant = 0.0;
+    bool chunking_enabled = false;
+    uint64_t rows_per_chunk = 1000000;
+    uint64_t bytes_per_chunk = 0;
+    bool shuffle_enabled = false;
+    int shuffle_buffer_size = 10000;
+    unsigned int shuffle_seed = 0;
 };
\ No newline at end of file
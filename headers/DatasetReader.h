@@ -0,0 +1,28 @@
+#ifndef DATASETREADER_H
+#define DATASETREADER_H
+
+#include "Types.h"
+
+// Reads back the records of a CSV dataset written by CSVWriter, one row at a time.
+// Files written before the IntersectionType column existed get their type inferred.
+class DatasetReader {
+public:
+    DatasetReader(const std::string& filename);
+
+    bool next(PairRecord& record);
+    const std::vector<std::string>& getHeaders() const { return headers; }
+
+private:
+    int column(const std::string& name) const;
+    static int inferType(const PairRecord& record);
+
+    std::ifstream inFile;
+    std::vector<std::string> headers;
+    int volumeColumn;
+    int intersectsColumn;
+    int typeColumn;
+    int gapColumn;
+    size_t line = 1;
+};
+
+#endif // DATASETREADER_H
@@ -0,0 +1,54 @@
+#ifndef DATASETSTATISTICS_H
+#define DATASETSTATISTICS_H
+
+#include "Types.h"
+
+// Count, mean, variance and range of a stream of values (Welford). Two accumulators over
+// disjoint parts of a stream merge into the accumulator of the whole stream.
+class RunningMoments {
+public:
+    void add(double value);
+    void merge(const RunningMoments& other);
+    json toJson() const;
+
+    uint64_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+};
+
+// Dataset statistics kept while records are accepted, so no second pass over the output is
+// needed: per-type counts, coordinate ranges and moments, tetrahedron volume and quality, and a
+// fine intersection volume histogram, and the gaps of separated pairs when the records carry
+// them (include_gap, as for the Gap column). Accumulators of separate workers can be merged.
+class DatasetStatistics {
+public:
+    DatasetStatistics(double histogram_min, double histogram_max, int histogram_bins, bool include_gap = false);
+
+    void add(const PairRecord& record);
+    void merge(const DatasetStatistics& other);
+    json toJson() const;
+    void write(const std::string& filename) const;
+
+    // Normalized volume to RMS edge length ratio: 1 for the regular tetrahedron, 0 when flat
+    static double quality(const Tetrahedron& T);
+
+private:
+    double histogram_min;
+    double histogram_max;
+    bool include_gap;
+    uint64_t rows = 0;
+    uint64_t intersecting = 0;
+    std::array<uint64_t, 5> rows_per_type{};
+    std::array<RunningMoments, 3> coordinates; // x, y, z over all vertices
+    RunningMoments intersection_volume;
+    RunningMoments tetrahedron_volume;
+    RunningMoments tetrahedron_quality;
+    RunningMoments gap;
+    std::vector<uint64_t> histogram;
+    uint64_t histogram_underflow = 0;
+    uint64_t histogram_overflow = 0;
+};
+
+#endif // DATASETSTATISTICS_H
@@ -0,0 +1,132 @@
+#ifndef GENERATORSERVER_H
+#define GENERATORSERVER_H
+
+#include "Types.h"
+#include "Config.h"
+#include "DatasetStatistics.h"
+#include "PairGenerator.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <thread>
+
+// Protocol on the Unix stream socket. A client sends requests as JSON objects, one per line:
+//
+//   {"id": 1, "count": 4096, "distribution": [20, 20, 20, 20, 20],
+//    "volume_min": 0.0, "volume_max": 0.01, "bins": 10, "seed": 7}
+//
+// Only count is required, at most MAX_PAIRS_PER_REQUEST; the distribution, volume range and bins
+// default to the configuration, and are checked like it, and the seed to a fresh random one.
+// {"stats": true} asks for the server statistics instead.
+// The server answers with frames, a 24-byte header followed by a payload (all fields
+// little-endian):
+//
+//   0   char     magic[4]   "TPGS"
+//   4   uint32   kind       a ServerFrameKind
+//   8   uint64   request    id of the request the frame belongs to
+//   16  uint32   count      records in a batch, records in total for done, payload bytes otherwise
+//   20  uint32   version    SERVER_PROTOCOL_VERSION
+//
+// A batch payload is count ServerRecords. The batches of a request arrive in any order, each
+// mixing types and bins, and a done frame follows the last one; its payload is a ServerDone with
+// the seed the request used. Error payloads are text, stats payloads JSON. A request whose bins
+// yield no record within MAX_CANDIDATES_PER_RECORD candidates gets one error frame, and its
+// remaining batches are skipped. Unless the containment
+// feeder is enabled, the same request with the same seed yields the same records.
+
+constexpr uint32_t SERVER_PROTOCOL_VERSION = 2;
+
+enum ServerFrameKind : uint32_t {
+    SERVER_FRAME_BATCH = 1,
+    SERVER_FRAME_DONE = 2,
+    SERVER_FRAME_ERROR = 3,
+    SERVER_FRAME_STATS = 4
+};
+
+struct ServerFrameHeader {
+    char magic[4];
+    uint32_t kind;
+    uint64_t request;
+    uint32_t count;
+    uint32_t version;
+};
+
+// Same fields as SharedMemoryRecord, without the slot sequence
+struct ServerRecord {
+    double coordinates[24]; // T1_v1_x ... T2_v4_z, same order as the CSV columns
+    double volume;
+    uint32_t intersects;
+    uint32_t type;
+};
+
+struct ServerDone {
+    uint64_t seed; // pass it back as "seed" to repeat the request
+};
+
+static_assert(sizeof(ServerFrameHeader) == 24, "Server frame header layout changed");
+static_assert(sizeof(ServerRecord) == 208, "Server record layout changed");
+static_assert(sizeof(ServerDone) == 8, "Server done payload layout changed");
+
+// Long-running generator that serves requests of many clients from one worker pool. Requests
+// are cut into batches that workers take from the clients in turn, so a large request does not
+// starve the others; each client may request at most max_pairs_per_client pairs in total.
+// Workers never write to sockets: frames are queued per client and sent by the client's own
+// thread as the client reads them. Workers skip clients with MAX_QUEUED_BATCHES batches unsent,
+// so a slow reader only slows down its own requests.
+class GeneratorServer {
+public:
+    GeneratorServer(const Configuration& config, int threads);
+    ~GeneratorServer();
+
+    void run();         // serves until stop() is called
+    static void stop(); // only sets a flag, so it may be called from a signal handler
+
+private:
+    struct Request;
+    struct Job;
+    struct Client;
+
+    void serveClient(const std::shared_ptr<Client>& client);
+    void handleRequest(const std::shared_ptr<Client>& client, const std::string& line);
+    void workLoop();
+    void runJob(Client& client, const Job& job);
+    bool sendFrame(Client& client, uint32_t kind, uint64_t request, uint32_t count, const void* payload, size_t bytes);
+    bool sendQueued(Client& client);
+    json statistics();
+
+    const Configuration& config;
+    int threads;
+    static constexpr size_t MAX_QUEUED_BATCHES = 4;
+    static constexpr int MAX_PAIRS_PER_REQUEST = 1 << 20;
+    static constexpr uint64_t MAX_CANDIDATES_PER_RECORD = 1 << 20; // a request fails after this many for one record
+
+    int batch_size;
+    uint64_t max_pairs_per_client;
+    size_t outbox_limit; // queued bytes at which a client gets no more batches
+    int listen_fd = -1;
+
+    std::vector<std::thread> workers;
+    std::mutex queue_mutex;
+    std::condition_variable queue_changed;
+    std::deque<std::shared_ptr<Client>> ready; // clients with queued batches, served round-robin
+    bool stopping = false;
+
+    std::list<std::pair<std::shared_ptr<Client>, std::thread>> connections;
+
+    std::mutex stats_mutex;
+    std::chrono::steady_clock::time_point started;
+    uint64_t requests = 0;
+    uint64_t rejected = 0;
+    uint64_t pairs = 0;
+    uint64_t batches = 0;
+    uint64_t bytes = 0;
+    RunningMoments first_batch_latency; // milliseconds from request to its first batch
+    RunningMoments request_duration;    // milliseconds from request to its done frame
+
+    static std::atomic<bool> stop_requested;
+};
+
+#endif // GENERATORSERVER_H
@@ -2,18 +2,35 @@
 #define GEOMETRYUTILS_H
 
 #include "Types.h"
+#include "TetrahedronBatchGenerator.h"
 
 class GeometryUtils {
 public:
+    // The calling thread's random draws, for owners that keep several independent streams
+    struct RandomState {
+        CGAL::Random random;
+        std::unique_ptr<TetrahedronBatchGenerator> batch;
+    };
+
     static bool checkIntersection(const Tetrahedron& T1, const Tetrahedron& T2);
     static IntersectionType getIntersectionClassification(const Tetrahedron& T1, const Tetrahedron& T2); 
     static std::vector<Point> getIntersectionShape(const Tetrahedron& T1, const Tetrahedron& T2);
     static double getIntersectionVolume(const Tetrahedron& T1, const Tetrahedron& T2);
+    static double getVolume(const Tetrahedron& T);
+    // Volume from double coordinates, for estimates and statistics where exact arithmetic is not needed
+    static double approximateVolume(const std::array<std::array<double, 3>, 4>& vertices);
+    static double approximateVolume(const Tetrahedron& T);
+    static double getDistance(const Tetrahedron& T1, const Tetrahedron& T2);
     static Mesh tetrahedronToMesh(const Tetrahedron& T);
     static Point generateRandomPoint();
     static Point generateRandomPointOnTriangle(const Point& A, const Point& B, const Point& C);
     static Point generateRandomPointOutsideTetrahedron(const Tetrahedron tetrahedron);
     static Tetrahedron generateRandomTetrahedron();
+    static void setSeed(unsigned int seed);
+    static void swapRandomState(RandomState& state);
+    static void setCoordinateGrid(int bits);
+    static int getCoordinateGrid();
+    static void setBatchGeneration(size_t batchSize, double minAbsDeterminant);
 
     class CoordinateSystem {
     public:
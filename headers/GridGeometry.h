@@ -0,0 +1,42 @@
+#ifndef GRIDGEOMETRY_H
+#define GRIDGEOMETRY_H
+
+#include "Types.h"
+
+// Exact geometry for tetrahedra whose vertices lie on a 2^-bits grid in the unit cube.
+// Coordinates are kept as integer grid indices, so every predicate is decided with
+// fixed-width integer arithmetic instead of lazy multi-precision numbers.
+class GridGeometry {
+public:
+    typedef std::array<int64_t, 3> GridPoint;
+    typedef std::array<GridPoint, 4> GridTetrahedron;
+
+    // Index differences are below 2^bits, so cross products fit int64 below 2^(2 bits + 1) and
+    // the __int128 dot products stay below 2^(3 bits + 3): predicates stay exact up to 30 bits.
+    // The double clip of partial overlaps has plane offsets up to 3 * 2^(3 bits + 1), exact up
+    // to 16 bits and rounded to 53 bits beyond, as its clipped vertices already are. Labels
+    // and containment volumes are exact at every supported size.
+    static constexpr int MAX_BITS = 20;
+
+    static GridPoint snap(const Point& p, int bits);
+    static GridTetrahedron snap(const Tetrahedron& T, int bits);
+    static Point toPoint(const GridPoint& p, int bits);
+    static Tetrahedron toTetrahedron(const GridTetrahedron& T, int bits);
+
+    static int orientation(const GridPoint& a, const GridPoint& b, const GridPoint& c, const GridPoint& d);
+    static __int128 signedSixVolume(const GridTetrahedron& T);
+    static bool isDegenerate(const GridTetrahedron& T);
+    static bool contains(const GridTetrahedron& outer, const GridTetrahedron& inner);
+
+    static bool checkIntersection(const GridTetrahedron& T1, const GridTetrahedron& T2);
+    static bool checkInteriorIntersection(const GridTetrahedron& T1, const GridTetrahedron& T2);
+    static double getIntersectionVolume(const GridTetrahedron& T1, const GridTetrahedron& T2, int bits);
+
+    // Same clipping on the double coordinates of arbitrary tetrahedra; a fast estimate, not exact
+    static double estimateIntersectionVolume(const Tetrahedron& T1, const Tetrahedron& T2);
+
+private:
+    static bool isSeparated(const GridTetrahedron& T1, const GridTetrahedron& T2, bool strict);
+};
+
+#endif // GRIDGEOMETRY_H
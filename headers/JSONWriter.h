@@ -2,16 +2,20 @@
 
 #include "Types.h"
 #include "BaseWriter.h"
+#include "OutputFile.h"
 
+// Streams the entries as one JSON array, so memory does not grow with the dataset
 class JSONWriter : public BaseWriter {
 public:
     JSONWriter(const std::string& filename);
     ~JSONWriter();
     void writeEntry(const Tetrahedron& T1, const Tetrahedron& T2, double volume, bool intersectionStatus);
+    void close();
+    uint64_t bytesWritten() { return static_cast<uint64_t>(outFile.tellp()); }
+    bool checksum(uint32_t& crc, uint64_t& size) { return outFile.checksum(crc, size); }
 
 private:
-    std::ofstream outFile;
-    json data;
+    OutputFile outFile;
     int idCounter = 1;
 
     json tetrahedronToJson(const Tetrahedron& tetrahedron);
@@ -0,0 +1,60 @@
+#ifndef MAPPEDDATASET_H
+#define MAPPEDDATASET_H
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Rows a read keeps: an empty type list accepts every type, the volume range is inclusive
+struct DatasetFilter {
+    std::vector<int> types;
+    double volume_min = -std::numeric_limits<double>::infinity();
+    double volume_max = std::numeric_limits<double>::infinity();
+};
+
+// The kept rows as contiguous arrays, in file order
+struct DatasetColumns {
+    size_t rows = 0;
+    std::vector<float> coordinates; // 24 per row, T1_v1_x ... T2_v4_z as in the CSV columns
+    std::vector<float> volumes;
+    std::vector<uint8_t> intersects;
+    std::vector<int8_t> types;      // 0 for contact rows of files without IntersectionType
+    std::vector<float> gaps;        // empty unless the file has a Gap column
+};
+
+// Reads CSV datasets written by CSVWriter without CGAL. The file is memory-mapped, cut into
+// chunks on row boundaries and the chunks are parsed on a pool of threads with std::from_chars,
+// straight into the output arrays. Columns are found by their header names, so the optional
+// IntersectionType and Gap columns may be missing. Gzip-compressed files are not supported.
+class MappedDataset {
+public:
+    explicit MappedDataset(const std::string& filename);
+    ~MappedDataset();
+    MappedDataset(const MappedDataset&) = delete;
+    MappedDataset& operator=(const MappedDataset&) = delete;
+
+    const std::vector<std::string>& getHeaders() const { return headers; }
+    bool hasTypes() const { return type_column >= 0; }
+    bool hasGaps() const { return gap_column >= 0; }
+    size_t sizeBytes() const { return size; }
+
+    // threads 0 uses every hardware thread. Throws std::runtime_error on a malformed row.
+    DatasetColumns read(const DatasetFilter& filter = DatasetFilter(), int threads = 0) const;
+
+private:
+    struct Chunk;
+
+    void parseChunk(Chunk& chunk, const DatasetFilter& filter, DatasetColumns& columns) const;
+
+    std::string filename;
+    const char* data = nullptr;
+    size_t size = 0;
+    size_t body = 0; // offset of the first row
+    std::vector<std::string> headers;
+    std::vector<int> roles; // per column: 0-23 coordinate, or one of the roles in MappedDataset.cpp
+    int type_column = -1;
+    int gap_column = -1;
+};
+
+#endif // MAPPEDDATASET_H
@@ -0,0 +1,62 @@
+#ifndef MEMORYMONITOR_H
+#define MEMORYMONITOR_H
+
+#include "Types.h"
+#include <map>
+#include <mutex>
+
+// Process memory as seen by the kernel (resident set) and by the allocator (heap in use).
+// While enabled, the pipeline reports every record: memory is sampled at a fixed record interval,
+// heap growth is attributed to the stage that caused it, and crossing the soft limit below the
+// ceiling asks the caller to flush buffered state.
+class MemoryMonitor {
+public:
+    // Heap growth between construction and destruction is added to the named stage. The heap is
+    // process-wide, so stages are only tracked when enabled with attributeStages, for runs where
+    // no two stages overlap.
+    class Stage {
+    public:
+        explicit Stage(const char* name);
+        ~Stage();
+
+    private:
+        const char* name;
+        int64_t heap;
+    };
+
+    static void enable(uint64_t sampleInterval, uint64_t ceilingBytes, bool attributeStages);
+    static bool isEnabled() { return enabled; }
+
+    static uint64_t residentBytes();
+    static uint64_t heapBytes();
+
+    // Called once per record. Returns true when the resident set is above the soft limit and no
+    // flush has been asked for within the last sample interval.
+    static bool record(uint64_t records);
+    // Returns freed heap pages to the kernel, after the caller has flushed its buffers
+    static void relieve();
+    // Waits, for at most a second, while the resident set is above the ceiling
+    static void throttle();
+
+    static json toJson();
+
+private:
+    struct StageUsage {
+        uint64_t calls = 0;
+        int64_t retained = 0;   // net heap growth over all calls
+        int64_t maxGrowth = 0;  // largest growth of a single call
+    };
+
+    static bool enabled;
+    static bool attributeStages;
+    static uint64_t sampleInterval;
+    static uint64_t ceiling;
+    static uint64_t softLimit;
+    static uint64_t nextSample;
+    static uint64_t quietUntil;
+    static std::mutex mutex;
+    static std::map<std::string, StageUsage> stages;
+    static json samples;
+};
+
+#endif // MEMORYMONITOR_H
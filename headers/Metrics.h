@@ -0,0 +1,23 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "Types.h"
+#include <map>
+#include <mutex>
+
+// Process-wide run metrics: named counters and values, written as a JSON sidecar
+class Metrics {
+public:
+    static void increment(const std::string& name, uint64_t amount = 1);
+    static void set(const std::string& name, const json& value);
+    static uint64_t count(const std::string& name); // 0 for a counter never incremented
+    static json toJson();
+    static void write(const std::string& filename);
+
+private:
+    static std::mutex mutex;
+    static std::map<std::string, uint64_t> counters;
+    static json values;
+};
+
+#endif // METRICS_H
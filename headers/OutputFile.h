@@ -0,0 +1,159 @@
+#ifndef OUTPUTFILE_H
+#define OUTPUTFILE_H
+
+#include "Types.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <zlib.h>
+
+// Stream buffer that gzip-compresses everything written to it. Full blocks are handed to a
+// worker thread, which deflates and writes them, so compression overlaps with generation.
+// At most MAX_QUEUED_BLOCKS wait for the worker; the writer blocks beyond that.
+class GzipStreamBuffer : public std::streambuf {
+public:
+    GzipStreamBuffer(int level);
+    ~GzipStreamBuffer();
+
+    bool open(const std::string& filename, bool append);
+    void finish(); // ends the gzip member and waits for the worker; throws if any write failed
+
+protected:
+    int_type overflow(int_type ch);
+    int sync();
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which);
+
+private:
+    static constexpr size_t BLOCK_SIZE = 1 << 20;
+    static constexpr size_t MAX_QUEUED_BLOCKS = 4;
+
+    void handOff();
+    bool hasError();
+    void compressLoop();
+
+    int level;
+    std::FILE* file = nullptr;
+    z_stream stream;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::vector<char>> queue;
+    std::vector<std::vector<char>> spare;
+    std::vector<char> block;
+    bool finishing = false;
+    bool finished = false;
+    std::string error;
+    uint64_t handedOff = 0;
+};
+
+// Stream buffer for plain files that keeps several large aligned blocks in flight. A full block
+// is submitted to io_uring, or to a writer thread calling pwrite where io_uring is unavailable,
+// and formatting continues in the next free block; the writer only blocks when every block is
+// still being written. With direct set, blocks bypass the page cache (O_DIRECT) where the file
+// system allows it, and the unaligned tail is written through the cache when the file closes.
+class AsyncStreamBuffer : public std::streambuf {
+public:
+    static constexpr size_t ALIGNMENT = 4096;
+
+    AsyncStreamBuffer(size_t blockSize, int count, bool direct);
+    ~AsyncStreamBuffer();
+
+    bool open(const std::string& filename, bool append);
+    void finish(); // writes the last block and waits for all of them; throws if any write failed
+    bool usesIoUring() const { return ring != nullptr; }
+
+protected:
+    int_type overflow(int_type ch);
+    int sync();
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which);
+
+private:
+    struct Ring; // io_uring queues, set up with raw system calls
+
+    struct Block {
+        char* data = nullptr;
+        size_t size = 0;
+        size_t written = 0;
+        uint64_t offset = 0;
+    };
+
+    void submit();            // writes the current block and continues in a free one
+    void write(int index);
+    void complete(int index, ssize_t result);
+    void waitForBlock();      // until a block is free or a write failed
+    void writeLoop();         // pwrite fallback
+    bool hasError();
+
+    size_t blockSize;
+    bool direct;
+    int fd = -1;
+    bool directActive = false;
+    std::vector<Block> blocks;
+    std::vector<int> freeBlocks;
+    int current = -1;
+    int inFlight = 0;
+    uint64_t offset = 0;      // file offset of the current block
+    bool finished = false;
+
+    std::unique_ptr<Ring> ring;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<int> queue;
+    bool stopping = false;
+    std::string error;
+};
+
+// Stream buffer in front of another one that keeps the CRC-32 and size of everything passed
+// through, so a finished file needs no second read to be checksummed.
+class ChecksumStreamBuffer : public std::streambuf {
+public:
+    explicit ChecksumStreamBuffer(std::streambuf* target);
+
+    uint32_t crc() const { return checksum; }
+    uint64_t size() const { return passed; }
+
+protected:
+    int_type overflow(int_type ch);
+    int sync();
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which);
+
+private:
+    static constexpr size_t BLOCK_SIZE = 1 << 16;
+
+    bool pass(); // hands the buffered bytes to the target
+
+    std::streambuf* target;
+    std::vector<char> block;
+    uint32_t checksum = 0;
+    uint64_t passed = 0;
+};
+
+// Output stream used by the file writers: a plain file, or a gzip file with ".gz" appended to
+// its name when compression is enabled through setCompression. With setAsyncWrites, plain files
+// are written through an AsyncStreamBuffer. With setChecksums, the bytes written are also
+// checksummed on their way to the file.
+class OutputFile : public std::ostream {
+public:
+    OutputFile() : std::ostream(nullptr) {}
+    ~OutputFile();
+
+    void open(const std::string& filename, std::ios::openmode mode = std::ios::out);
+    bool is_open() const { return buffer != nullptr; }
+    void close(); // throws if any write or the close failed, including those of the worker threads
+    // CRC-32 and size of the bytes written since open, which are the file's bytes unless it is
+    // compressed or appended to; false without setChecksums. Still valid after close.
+    bool checksum(uint32_t& crc, uint64_t& size) const;
+
+    static void setCompression(int level); // 0 disables compression, 1-9 is the zlib level
+    static int getCompression();
+    static void setAsyncWrites(size_t blockSize, int blocks, bool direct); // 0 blocks writes synchronously
+    static void setChecksums(bool enabled);
+
+private:
+    std::unique_ptr<std::streambuf> buffer;
+    std::unique_ptr<ChecksumStreamBuffer> checksumBuffer; // in front of buffer, with setChecksums
+};
+
+#endif // OUTPUTFILE_H
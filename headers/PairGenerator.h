@@ -0,0 +1,86 @@
+#ifndef PAIRGENERATOR_H
+#define PAIRGENERATOR_H
+
+#include "Types.h"
+#include "Config.h"
+#include "VolumeBounds.h"
+#include "WorkStealingScheduler.h"
+#include <atomic>
+#include <functional>
+#include <random>
+
+// Produces labelled tetrahedron pairs that follow the configured intersection type
+// distribution and the uniform volume bins of type 5, one accepted record at a time.
+// For parallel runs, remainingSlices splits the open quotas into slices and generate produces
+// a record for one slice; it only reads the quotas and may be called from several threads.
+class PairGenerator {
+public:
+    PairGenerator(const Configuration& config);
+    PairGenerator(int dataset_size, const std::vector<double>& distribution, double min_volume, double max_volume, int num_bins);
+
+    void configure(const Configuration& config); // applies the optional generation settings
+
+    bool hasNext() const { return generated < dataset_size; }
+    PairRecord next();
+    // Same as next, but checks stopped() before every candidate and returns false once it is true
+    bool next(PairRecord& record, const std::function<bool()>& stopped);
+    PairRecord generate(int type, int bin);
+    // Same as generate, but checks stopped() before every candidate and returns false once it is true
+    bool generate(int type, int bin, PairRecord& record, const std::function<bool()>& stopped);
+    std::vector<WorkSlice> remainingSlices(int slice_size) const;
+    bool resume(const PairRecord& record);
+    void reset();
+    void setRandomSchedule(unsigned int seed);
+    void setBalancedSchedule(bool enabled);
+    void setGapOutput(bool enabled) { gap_output = enabled; }
+    void setContainmentFeeder(double from_volume, double fraction);
+    void setLabelShortcut(double audit_rate);
+    void setPrefilter(const std::vector<VolumeBounds::Stage>& stages, double tolerance);
+
+    int getGenerated() const { return generated; }
+    int getDatasetSize() const { return dataset_size; }
+    int getSurplus() const { return surplus; }
+    const std::vector<int>& getEntriesPerType() const { return entries_per_type; }
+    const std::vector<int>& getGeneratedPerType() const { return generated_per_type; }
+    const std::vector<int>& getVolumeDistribution() const { return volume_distribution; }
+
+private:
+    int nextType();
+    int volumeBin(double volume) const;
+    int binLimit(int bin) const;
+    int containmentBin() const;
+    bool auditNext();
+    bool feedNext();
+    void checkLabel(int type, bool intersection_status, double intersection_volume) const;
+    bool hitsOpenBin(double lower, double upper) const;
+    bool passesPrefilter(const Tetrahedron& T1, const Tetrahedron& T2, const std::function<bool(double, double)>& reachable) const;
+    bool buildCandidate(int type, int feeder_bin, const std::function<bool(double, double)>& reachable, PairRecord& record);
+    void addGap(PairRecord& record) const;
+
+    int dataset_size;
+    double min_volume;
+    double max_volume;
+    int num_bins;
+    int generated = 0;
+    bool random_schedule = false;
+    bool balanced_schedule = false;
+    bool gap_output = false;
+    double containment_from_volume = 0.0;
+    double containment_fraction = 0.0;
+    int containment_generated = 0;
+    int surplus = 0;
+    std::vector<VolumeBounds::Stage> prefilter_stages;
+    double prefilter_tolerance = 0.0;
+    bool label_shortcut = false;
+    double label_audit_rate = 0.0;
+    std::atomic<uint64_t> labelled{0};
+    std::atomic<uint64_t> fed{0};
+    std::mt19937 schedule_generator;
+
+    std::vector<int> entries_per_type;
+    std::vector<int> generated_per_type;
+    std::vector<int> entries_per_bin;
+    std::vector<int> volume_distribution;
+};
+
+#endif // PAIRGENERATOR_H
@@ -0,0 +1,48 @@
+#ifndef SCENEGENERATOR_H
+#define SCENEGENERATOR_H
+
+#include "Types.h"
+
+// Two tetrahedra of a scene that intersect, by index, with their common volume
+struct SceneEdge {
+    int first;
+    int second;
+    double volume;
+};
+
+struct Scene {
+    std::vector<Tetrahedron> tetrahedra;
+    std::vector<SceneEdge> edges; // sorted by (first, second), first < second
+};
+
+// Generates scenes of random tetrahedra in the unit cube labelled with every intersecting pair.
+// A uniform grid over the bounding boxes yields the candidate pairs, so only tetrahedra whose
+// boxes overlap reach the narrow phase, which runs on a pool of threads.
+class SceneGenerator {
+public:
+    enum NarrowPhase {
+        Exact,    // exact intersection test and exact volume
+        Estimate  // exact intersection test, volume from the double-precision clip
+    };
+
+    static NarrowPhase parseNarrowPhase(const std::string& name);
+
+    // Each tetrahedron is shrunk by scale towards a random point of the cube, so scale sets its size
+    SceneGenerator(int tetrahedra, double scale, NarrowPhase narrow_phase, int threads);
+
+    Scene next();
+
+private:
+    typedef std::array<double, 12> Coordinates;
+    typedef std::array<double, 6> Box; // min x, y, z, then max x, y, z
+
+    Tetrahedron randomTetrahedron() const;
+    std::vector<SceneEdge> findEdges(const std::vector<Coordinates>& coordinates) const;
+
+    int tetrahedra;
+    double scale;
+    NarrowPhase narrow_phase;
+    int threads;
+};
+
+#endif // SCENEGENERATOR_H
@@ -0,0 +1,23 @@
+#ifndef SCENEWRITER_H
+#define SCENEWRITER_H
+
+#include "Types.h"
+#include "OutputFile.h"
+#include "SceneGenerator.h"
+
+// Writes scenes as two CSV files: one row per tetrahedron (Scene, Id, vertices), and a sparse
+// adjacency list with one row per intersecting pair (Scene, First, Second, IntersectionVolume).
+class SceneWriter {
+public:
+    SceneWriter(const std::string& tetrahedraFilename, const std::string& pairsFilename, int prec = 6);
+    ~SceneWriter();
+    void writeScene(int sceneId, const Scene& scene);
+    void close(); // throws if the files could not be completed; the destructor only reports it
+
+private:
+    OutputFile tetrahedraFile;
+    OutputFile pairsFile;
+    int precision;
+};
+
+#endif // SCENEWRITER_H
@@ -0,0 +1,70 @@
+#ifndef SHAREDMEMORYWRITER_H
+#define SHAREDMEMORYWRITER_H
+
+#include "Types.h"
+#include "BaseWriter.h"
+#include <atomic>
+
+// Layout of the POSIX shared-memory segment (all fields little-endian, offsets in bytes):
+//
+//   0   char     magic[8]       "TPGRING\0"
+//   8   uint32   version        SHM_RING_VERSION
+//   12  uint32   record_size    sizeof(SharedMemoryRecord)
+//   16  uint64   capacity       number of slots, a power of two
+//   24  uint32   drop_oldest    1 if the producer overwrites unread records when full
+//   28  uint32   closed         set to 1 once the producer has written its last record
+//   64  uint64   head           index of the next record the producer will publish
+//   128 uint64   tail           index of the next record the consumer will read
+//   192          slots          capacity * record_size bytes
+//
+// Record i lives in slot i % capacity. A slot is readable once its sequence equals
+// 2 * i + 2; the producer sets it to 2 * i + 1 while writing. The consumer reads the
+// record in place and then advances tail with a compare-and-swap from i to i + 1.
+// In drop-oldest mode the producer may advance tail itself when the ring is full, so
+// the consumer must re-check the slot sequence after using the record and discard it
+// if it changed or if its compare-and-swap fails.
+
+constexpr uint32_t SHM_RING_VERSION = 1;
+
+struct SharedMemoryRecord {
+    std::atomic<uint64_t> sequence;
+    double coordinates[24];  // T1_v1_x ... T2_v4_z, same order as the CSV columns
+    double volume;
+    uint32_t intersects;
+    uint32_t type;
+};
+
+struct SharedMemoryRingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t capacity;
+    uint32_t drop_oldest;
+    std::atomic<uint32_t> closed;
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+    char padding[56];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared ring needs address-free 64-bit atomics");
+static_assert(sizeof(SharedMemoryRecord) == 216, "Shared ring record layout changed");
+static_assert(sizeof(SharedMemoryRingHeader) == 192, "Shared ring header layout changed");
+
+class SharedMemoryWriter : public BaseWriter {
+public:
+    // In blocking mode, timeout is how long a full ring may go without the consumer reading a
+    // record before writes fail; 0 waits forever
+    SharedMemoryWriter(const std::string& name, uint64_t capacity, bool drop_oldest, double timeout = 0.0);
+    ~SharedMemoryWriter();
+    void writeEntry(const Tetrahedron& T1, const Tetrahedron& T2, double volume, bool intersects);
+    void writeRecord(const PairRecord& record);
+
+private:
+    std::string name;
+    double timeout;
+    size_t mapped_size = 0;
+    SharedMemoryRingHeader* ring = nullptr;
+    SharedMemoryRecord* slots = nullptr;
+};
+
+#endif // SHAREDMEMORYWRITER_H
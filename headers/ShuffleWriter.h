@@ -0,0 +1,26 @@
+#ifndef SHUFFLEWRITER_H
+#define SHUFFLEWRITER_H
+
+#include "Types.h"
+#include "BaseWriter.h"
+#include <random>
+
+// Holds up to bufferSize records and forwards a uniformly chosen one to the wrapped
+// writer each time a new record arrives, so output is mixed in one bounded-memory pass.
+class ShuffleWriter : public BaseWriter {
+public:
+    ShuffleWriter(std::unique_ptr<BaseWriter> writer, size_t bufferSize, unsigned int seed);
+    ~ShuffleWriter();
+    void writeEntry(const Tetrahedron& T1, const Tetrahedron& T2, double volume, bool intersects);
+    void writeRecord(const PairRecord& record);
+    void flush();
+    void close(); // writes the buffered records and closes the wrapped writer
+
+private:
+    std::unique_ptr<BaseWriter> writer;
+    size_t bufferSize;
+    std::vector<PairRecord> buffer;
+    std::mt19937 randomGenerator;
+};
+
+#endif // SHUFFLEWRITER_H
@@ -0,0 +1,35 @@
+#ifndef TETRAHEDRONBATCHGENERATOR_H
+#define TETRAHEDRONBATCHGENERATOR_H
+
+#include "Types.h"
+
+// Generates random tetrahedra in the unit cube a batch at a time. Coordinates come from a
+// counter-based Philox4x32-10 generator and are stored as structure-of-arrays, so both the
+// random draws and the orientation determinants vectorize across tetrahedra.
+class TetrahedronBatchGenerator {
+public:
+    TetrahedronBatchGenerator(uint64_t seed, size_t batchSize = 1024, double minAbsDeterminant = 0.0, int gridBits = 0);
+
+    Tetrahedron next();
+    size_t fill();
+
+    // Bound on the rounding error of the double determinant for coordinates in [0, 1];
+    // anything larger has the same sign as the exact orientation
+    static constexpr double DETERMINANT_ERROR_BOUND = 1e-14;
+
+private:
+    void generateCoordinates(size_t count);
+
+    uint32_t key[2];
+    uint64_t counter = 0;
+    size_t batchSize;
+    double minAbsDeterminant;
+    int gridBits;
+
+    std::array<std::vector<double>, 12> coordinates; // x, y, z of vertices 0..3
+    std::vector<double> determinants;
+    std::vector<uint32_t> accepted;
+    size_t nextAccepted = 0;
+};
+
+#endif // TETRAHEDRONBATCHGENERATOR_H
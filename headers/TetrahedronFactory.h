@@ -2,16 +2,31 @@
 #define TETRAHEDRONFACTORY_H
 
 #include "Types.h"
+#include "GeometryUtils.h"
+#include <random>
 
 class TetrahedronFactory {
 public:
+    // Everything setSeed resets on the calling thread: the random streams and attempt budgets
+    struct RandomState {
+        GeometryUtils::RandomState geometry;
+        std::mt19937 attempts;
+        std::array<double, 3> budgets{};
+    };
+
     static std::pair<Tetrahedron, Tetrahedron> createRandomTetrahedronPair(int type = 0);
     static std::pair<Tetrahedron, Tetrahedron> createRandomTetrahedronPair();
     static std::pair<Tetrahedron, Tetrahedron> NoIntersection();
+    static std::pair<Tetrahedron, Tetrahedron> NearMissIntersection();
     static std::pair<Tetrahedron, Tetrahedron> PointIntersection();
     static std::pair<Tetrahedron, Tetrahedron> LineIntersection();
     static std::pair<Tetrahedron, Tetrahedron> PolygonIntersection();
     static std::pair<Tetrahedron, Tetrahedron> PolyhedronIntersection();
+    static std::pair<Tetrahedron, Tetrahedron> ContainmentIntersection(double volume_min, double volume_max);
+    static void setSeed(unsigned int seed);
+    // Exchanges the calling thread's state with state, so a stream can be parked and resumed
+    static void swapRandomState(RandomState& state);
+    static void setNearMiss(double fraction, double gap_min, double gap_max);
     
 };
 
@@ -0,0 +1,60 @@
+#ifndef TETRAHEDRONPAIRAPI_H
+#define TETRAHEDRONPAIRAPI_H
+
+/*
+ * Stable C interface for generating tetrahedron pairs in-process, e.g. from a data loader.
+ *
+ * Each pair is written as 24 floats in the CSV column order
+ * (T1_v1_x, T1_v1_y, T1_v1_z, ..., T2_v4_z), followed by one volume and one
+ * intersection flag (0 or 1) per pair in separate buffers.
+ *
+ * The coordinate grid, near-miss and batch generation settings apply to the whole process.
+ * Several generators may be alive at once only if they share these settings: creating one whose
+ * settings differ from those of the generators already alive fails. Generators created with
+ * tpg_create_with_params use none of these features.
+ *
+ * Each generator keeps its own random stream, so the pairs it returns depend only on its seed
+ * and the calls made to it, not on other generators or on which thread calls it. A generator
+ * may move between threads but must not be used by two threads at once.
+ */
+
+#define TPG_API_VERSION 1
+#define TPG_FLOATS_PER_PAIR 24
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct tpg_generator tpg_generator;
+
+int tpg_api_version(void);
+
+/* Creates a generator from a configuration file; returns NULL on failure, see tpg_last_error. */
+tpg_generator* tpg_create(const char* config_path, unsigned int seed);
+
+/*
+ * Creates a generator from explicit parameters; distribution holds the 5 type percentages, which
+ * must be non-negative and sum to 100. round_size must give every nonzero type at least one pair
+ * per round, and polyhedron pairs at least one per volume bin.
+ */
+tpg_generator* tpg_create_with_params(const double* distribution, double volume_min, double volume_max,
+                                      int num_bins, int round_size, unsigned int seed);
+
+/*
+ * Fills count pairs into coordinates (count * TPG_FLOATS_PER_PAIR), volumes (count) and
+ * intersects (count). Any output buffer except coordinates may be NULL. The type distribution
+ * and volume bins are honoured over rounds of round_size pairs, with types in random order.
+ * Returns the number of pairs written, or -1 on failure.
+ */
+int tpg_generate(tpg_generator* generator, int count, float* coordinates, float* volumes, float* intersects);
+
+void tpg_destroy(tpg_generator* generator);
+
+/* Message of the last failure on the calling thread, or an empty string. */
+const char* tpg_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TETRAHEDRONPAIRAPI_H
@@ -17,6 +17,8 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <limits>
+#include <array>
+#include <cstdint>
 
 #include <CGAL/Exact_predicates_exact_constructions_kernel.h>
 #include <CGAL/Nef_polyhedron_3.h>
@@ -61,4 +63,14 @@ enum class IntersectionType {
 
 using json = nlohmann::json;
 
-constexpr double epsilon = 1e-16;
\ No newline at end of file
+constexpr double epsilon = 1e-16;
+
+// A labelled tetrahedron pair as accepted by the generator
+struct PairRecord {
+    Tetrahedron T1;
+    Tetrahedron T2;
+    double volume;
+    bool intersects;
+    int type;
+    double gap = 0.0; // exact distance between the tetrahedra, 0 when they intersect
+};
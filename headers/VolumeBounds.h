@@ -0,0 +1,26 @@
+#ifndef VOLUMEBOUNDS_H
+#define VOLUMEBOUNDS_H
+
+#include "Types.h"
+
+// Cheap intervals that contain the intersection volume of two tetrahedra, ordered from the
+// cheapest and loosest to the most expensive and tightest. They let candidates whose volume
+// cannot land in an open bin be rejected before the exact computation. Only true bounds belong
+// here: the double-precision clip estimate has no proven error bound and is not a stage.
+class VolumeBounds {
+public:
+    enum class Stage { Volume, BoundingBox };
+
+    struct Interval {
+        double lower;
+        double upper;
+    };
+
+    static Stage parseStage(const std::string& name);
+    static std::string stageName(Stage stage);
+
+    // Every interval is widened by the tolerance to absorb rounding in the double arithmetic
+    static Interval compute(Stage stage, const Tetrahedron& T1, const Tetrahedron& T2, double tolerance);
+};
+
+#endif // VOLUMEBOUNDS_H
@@ -0,0 +1,59 @@
+#ifndef WORKSTEALINGSCHEDULER_H
+#define WORKSTEALINGSCHEDULER_H
+
+#include "Types.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+// A share of the dataset quotas: `count` records of one type, and of one volume bin for type 5
+struct WorkSlice {
+    int type;
+    int bin; // -1 for types without volume bins
+    int count;
+};
+
+// Runs quota slices on a pool of threads. Every worker owns a deque of slices: it takes work from
+// the back of its own deque and steals from the front of others when it runs dry. While a worker
+// is idle, busy workers hand off half of their remaining slice, so a slow bin ends up split across
+// every thread instead of finishing on one. Workers that find nothing to steal sleep until a
+// slice is handed off or the last record is done.
+class WorkStealingScheduler {
+public:
+    typedef std::function<void(int worker)> InitFunction;
+    typedef std::function<PairRecord(const WorkSlice& slice)> ProduceFunction;
+    typedef std::function<void(const PairRecord& record)> ConsumeFunction;
+
+    WorkStealingScheduler(int threads);
+
+    // Produces every record of the slices; consume is called one record at a time. The first
+    // exception thrown by a worker stops the others and is rethrown here.
+    void run(const std::vector<WorkSlice>& slices, const InitFunction& init, const ProduceFunction& produce, const ConsumeFunction& consume);
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<WorkSlice> slices;
+    };
+
+    void work(int index, const InitFunction& init, const ProduceFunction& produce, const ConsumeFunction& consume);
+    bool take(int index, WorkSlice& slice);
+    bool steal(int index, WorkSlice& slice);
+    void wakeIdle(bool all);
+
+    int threads;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<int64_t> remaining{0};
+    std::atomic<int> idle{0};
+    std::atomic<bool> failed{false};
+    std::mutex idleMutex;
+    std::condition_variable workAvailable;
+    uint64_t handOffs = 0; // guarded by idleMutex; idle workers wait for it to change
+    std::mutex consumeMutex;
+    std::mutex errorMutex;
+    std::exception_ptr error;
+};
+
+#endif // WORKSTEALINGSCHEDULER_H
@@ -3,106 +3,226 @@
 #include "headers/OBJWriter.h"
 #include "headers/GeometryUtils.h"
 #include "headers/TetrahedronFactory.h"
+#include "headers/PairGenerator.h"
+#include "headers/DatasetReader.h"
+#include "headers/OutputFile.h"
 #include "headers/Types.h"
 #include "headers/Utils.h"
 #include "headers/Config.h"
+#include "headers/Metrics.h"
+#include "headers/MemoryMonitor.h"
+#include "headers/DatasetStatistics.h"
+#include "headers/WorkStealingScheduler.h"
+#include "headers/SceneGenerator.h"
+#include "headers/SceneWriter.h"
+#include "headers/GeneratorServer.h"
+#include <chrono>
+#include <csignal>
+#include <thread>
+
+// Set by SIGINT/SIGTERM during a time-budgeted run, which then ends as on timeout
+static volatile std::sig_atomic_t interrupted = 0;
 
 int main() {
     try {
-        srand(static_cast<unsigned int>(time(nullptr)));
-
         Configuration config;
         const int number_of_entries = config.getDatasetSize();
-        const std::string format = config.getOutputFormat();
-        const auto& distribution = config.getIntersectionDistribution();
-        const auto precision = config.getPrecision();
-        const auto min_volume = config.getMinVolume();
-        const auto max_volume = config.getMaxVolume();
-        const auto num_bins = config.getNumBins();
-
-        auto writer = BaseWriter::createWriter(format, number_of_entries, precision);
-        if (!writer) {
-            std::cerr << "Failed to create writer." << std::endl;
-            return 1;
+
+        if (config.isGridEnabled()) {
+            GeometryUtils::setCoordinateGrid(config.getGridBits());
+        }
+        if (config.getCompressionFormat() == "gzip") {
+            OutputFile::setCompression(config.getCompressionLevel());
+        }
+        if (config.isAsyncOutputEnabled()) {
+            OutputFile::setAsyncWrites(static_cast<size_t>(config.getAsyncOutputBlockMb()) << 20, config.getAsyncOutputBlocks(), config.isAsyncOutputDirect());
+        }
+        // Chunks are checksummed for the manifest while they are written
+        OutputFile::setChecksums(config.isChunkingEnabled());
+        if (config.isNearMissEnabled()) {
+            TetrahedronFactory::setNearMiss(config.getNearMissFraction(), config.getNearMissGapMin(), config.getNearMissGapMax());
+        }
+        if (config.isBatchGenerationEnabled()) {
+            GeometryUtils::setBatchGeneration(config.getBatchSize(), config.getMinAbsDeterminant());
         }
 
-        // Calculate entries per type
-        std::vector<int> entries_per_type(distribution.size());
-        std::vector<int> generated_per_type(distribution.size(), 0);
-        int remaining_entries = number_of_entries;
+        const unsigned int seed = config.getSeed() != 0 ? config.getSeed() : static_cast<unsigned int>(time(nullptr));
+        TetrahedronFactory::setSeed(seed);
+        Metrics::set("seed", seed);
 
-        for (size_t i = 0; i < distribution.size(); i++) {
-            entries_per_type[i] = static_cast<int>((distribution[i] / 100.0) * number_of_entries);
-            remaining_entries -= entries_per_type[i];
-        }
-        entries_per_type[0] += remaining_entries;
-        std::unique_ptr<TetrahedronFactory> tetrahedron_factory = std::make_unique<TetrahedronFactory>();
-
-        const auto size_of_interval = (max_volume - min_volume) / num_bins;
-        std::vector<int> volume_distribution (num_bins, 0);
-        const auto number_of_entries_per_bin = static_cast<int> (entries_per_type[4] / num_bins); // uniform distribution of volume
-
-        // Generate tetrahedrons based on configuration
-        for (int i = 0; i < number_of_entries; ++i) {
-            std::unique_ptr<Tetrahedron> tetrahedron1;
-            std::unique_ptr<Tetrahedron> tetrahedron2;
-
-            // Find next type that needs more entries
-            int type = 0;
-            for (size_t j = 0; j < entries_per_type.size(); j++) {
-                if (generated_per_type[j] < entries_per_type[j]) {
-                    type = j + 1;
-                    generated_per_type[j]++;
-                    break;
-                }
-            }
+        int threads = config.getParallelThreads();
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        Metrics::set("parallel.threads", threads);
 
-            auto tetrahedron_pair = tetrahedron_factory->createRandomTetrahedronPair(type);
-            tetrahedron1 = std::make_unique<Tetrahedron>(tetrahedron_pair.first);
-            tetrahedron2 = std::make_unique<Tetrahedron>(tetrahedron_pair.second);
+        if (config.isMemoryMonitorEnabled()) {
+            // Parallel pair workers overlap their stages on the shared heap; scene stages run one at a time
+            MemoryMonitor::enable(config.getMemorySampleInterval(), static_cast<uint64_t>(config.getMemoryCeilingMb() * 1024 * 1024),
+                                  config.isSceneEnabled() || threads == 1);
+        }
 
-            bool intersection_status = GeometryUtils::checkIntersection(*tetrahedron1, *tetrahedron2);
-            double intersection_volume = GeometryUtils::getIntersectionVolume(*tetrahedron1, *tetrahedron2);
+        // The daemon answers requests until interrupted instead of writing a dataset
+        if (config.isServerEnabled()) {
+            GeneratorServer server(config, threads);
+            std::signal(SIGINT, [](int) { GeneratorServer::stop(); });
+            std::signal(SIGTERM, [](int) { GeneratorServer::stop(); });
+            server.run();
+            Metrics::write(formatFilename("metrics.json", number_of_entries, "server"));
+            return 0;
+        }
 
-            if (type == 5) {
-                if (intersection_volume < min_volume || intersection_volume > max_volume) {
-                    // Discard entry if volume is out of range
-                    generated_per_type[type - 1]--;
-                    i--;
-                    continue;
+        // Scenes replace the pair dataset: tetrahedra and intersecting pairs go to their own files
+        if (config.isSceneEnabled()) {
+            const int tetrahedra = config.getSceneTetrahedra();
+            SceneGenerator scenes(tetrahedra, config.getSceneScale(), SceneGenerator::parseNarrowPhase(config.getSceneNarrowPhase()), threads);
+            {
+                SceneWriter writer(formatFilename("csv", tetrahedra, "scene_tetrahedra"), formatFilename("csv", tetrahedra, "scene_pairs"), config.getPrecision());
+                for (int scene = 0; scene < config.getSceneCount(); ++scene) {
+                    Scene current = [&] {
+                        MemoryMonitor::Stage stage("scene");
+                        return scenes.next();
+                    }();
+                    {
+                        MemoryMonitor::Stage stage("write");
+                        writer.writeScene(scene, current);
+                    }
+                    if (MemoryMonitor::record(scene + 1)) MemoryMonitor::relieve();
+                    print_progress_bar(scene + 1, config.getSceneCount());
                 }
+                writer.close();
+            }
+            if (MemoryMonitor::isEnabled()) Metrics::set("memory", MemoryMonitor::toJson());
+            Metrics::write(formatFilename("metrics.json", tetrahedra, "scene"));
+            std::cout << std::endl;
+            return 0;
+        }
 
-                // Calculate the correct bin for the volume
-                double normalized_volume = intersection_volume - min_volume;
-                int bin = static_cast<int>(normalized_volume / size_of_interval);
+        PairGenerator generator(config);
 
-                // Clamp the bin to valid range
-                if (bin < 0) {
-                    bin = 0;
-                } else if (bin >= num_bins) {
-                    bin = num_bins - 1;
-                }
+        // Existing rows count towards the quotas, so only the missing ones are generated
+        if (config.isTopUpEnabled()) {
+            DatasetReader reader(config.getTopUpInput());
+            PairRecord existing;
+            int rows = 0;
+            while (reader.next(existing)) {
+                generator.resume(existing);
+                rows++;
+            }
+            Metrics::set("top_up.existing_rows", rows);
+            Metrics::set("top_up.surplus_rows", generator.getSurplus());
+            Metrics::set("top_up.missing_rows", generator.getDatasetSize() - generator.getGenerated());
+        }
 
-                assert(bin >= 0 && bin < num_bins);
+        auto writer = BaseWriter::createWriter(config);
+        if (!writer) {
+            std::cerr << "Failed to create writer." << std::endl;
+            return 1;
+        }
 
-                // Check if the current bin is already full
-                if (volume_distribution[bin] >= number_of_entries_per_bin) {
-                    // Discard entry if bin is full
-                    generated_per_type[type - 1]--;
-                    i--;
-                    continue;
-                }
+        DatasetStatistics statistics(config.getMinVolume(), config.getMaxVolume(), config.getStatisticsHistogramBins(),
+                                     config.isNearMissEnabled());
 
-                // Accept the entry and increment the bin count
-                volume_distribution[bin]++;
+        // Parallel workers keep their own statistics outside the consume lock, merged after the run
+        std::vector<DatasetStatistics> worker_statistics;
+        auto store = [&](const PairRecord& record) {
+            {
+                MemoryMonitor::Stage stage("write");
+                writer->writeRecord(record);
+            }
+            if (config.isStatisticsEnabled() && worker_statistics.empty()) {
+                MemoryMonitor::Stage stage("statistics");
+                statistics.add(record);
+            }
+            // Near the memory ceiling, buffered records go to the files before more are generated
+            if (MemoryMonitor::record(generator.getGenerated())) {
+                writer->flush();
+                MemoryMonitor::relieve();
             }
 
-            writer->writeEntry(*tetrahedron1, *tetrahedron2, intersection_volume, intersection_status);
+            print_progress_bar(generator.getGenerated(), number_of_entries);
+        };
+
+        if (threads > 1) {
+            // Each worker draws from its own seed; records are written as they complete
+            static thread_local int worker_index = 0;
+            if (config.isStatisticsEnabled()) worker_statistics.assign(threads, statistics);
+            WorkStealingScheduler scheduler(threads);
+            scheduler.run(generator.remainingSlices(config.getParallelSliceSize()),
+                [&](int worker) {
+                    worker_index = worker;
+                    TetrahedronFactory::setSeed(seed + worker + 1);
+                },
+                [&](const WorkSlice& slice) {
+                    // Above the ceiling only the first worker keeps full speed
+                    if (worker_index > 0) MemoryMonitor::throttle();
+                    PairRecord record = [&] {
+                        MemoryMonitor::Stage stage("generate");
+                        return generator.generate(slice.type, slice.bin);
+                    }();
+                    if (!worker_statistics.empty()) {
+                        MemoryMonitor::Stage stage("statistics");
+                        worker_statistics[worker_index].add(record);
+                    }
+                    return record;
+                },
+                [&](const PairRecord& record) {
+                    generator.resume(record);
+                    store(record);
+                });
+            for (const auto& partial : worker_statistics) statistics.merge(partial);
+        } else {
+            const auto started = std::chrono::steady_clock::now();
+            const int existing = generator.getGenerated();
+            auto elapsedSeconds = [&] { return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count(); };
+            auto outOfTime = [&] { return config.isTimeBudgetEnabled() && (interrupted || elapsedSeconds() >= config.getTimeBudgetSeconds()); };
+            if (config.isTimeBudgetEnabled()) {
+                std::signal(SIGINT, [](int) { interrupted = 1; });
+                std::signal(SIGTERM, [](int) { interrupted = 1; });
+            }
 
-            print_progress_bar(i + 1, number_of_entries);
+            // Generate tetrahedrons based on configuration; the budget also cuts a record's rejection loop short
+            while (generator.hasNext()) {
+                PairRecord record;
+                const bool produced = [&] {
+                    MemoryMonitor::Stage stage("generate");
+                    return generator.next(record, outOfTime);
+                }();
+                if (!produced) break;
+                store(record);
+            }
 
+            if (config.isTimeBudgetEnabled()) {
+                const double elapsed = elapsedSeconds();
+                const int records = generator.getGenerated() - existing;
+                json report;
+                report["budget_seconds"] = config.getTimeBudgetSeconds();
+                report["elapsed_seconds"] = elapsed;
+                report["records"] = records;
+                report["records_per_second"] = elapsed > 0 ? records / elapsed : 0.0;
+                report["completed"] = !generator.hasNext();
+                report["interrupted"] = interrupted != 0;
+                report["generated_per_type"] = generator.getGeneratedPerType();
+                report["volume_distribution"] = generator.getVolumeDistribution();
+                Metrics::set("time_budget", report);
+
+                std::cout << std::endl << "Generated " << records << " records in " << elapsed << " s ("
+                          << report["records_per_second"].get<double>() << " records/s)"
+                          << (generator.hasNext() ? ", stopped before dataset_size" : "") << std::endl;
+            }
         }
+        // Buffered records, trailers and closing happen here, where a failure still fails the run
+        writer->close();
         writer.reset();
+
+        if (const uint64_t mismatches = Metrics::count("label_audit.mismatches")) {
+            std::cerr << std::endl << "Warning: " << mismatches << " of " << Metrics::count("label_audit.audited")
+                      << " audited shortcut labels differ from the exact pipeline; see label_audit in the metrics sidecar" << std::endl;
+        }
+
+        if (MemoryMonitor::isEnabled()) Metrics::set("memory", MemoryMonitor::toJson());
+        Metrics::write(formatFilename("metrics.json", number_of_entries));
+        if (config.isStatisticsEnabled()) {
+            statistics.write(formatFilename("stats.json", number_of_entries));
+        }
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
@@ -0,0 +1,282 @@
+#include "ArrowWriter.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Values from the Arrow flatbuffer schemas (Schema.fbs, Message.fbs)
+constexpr int16_t METADATA_V5 = 4;
+constexpr uint8_t HEADER_SCHEMA = 1;
+constexpr uint8_t HEADER_RECORD_BATCH = 3;
+constexpr uint8_t TYPE_INT = 2;
+constexpr uint8_t TYPE_FLOATING_POINT = 3;
+constexpr uint8_t TYPE_BOOL = 6;
+constexpr int16_t PRECISION_DOUBLE = 2;
+
+// Minimal FlatBuffers encoder writing front to back: every object is appended after the field
+// that references it, so all unsigned offsets point forward, and each vtable sits just before
+// its table. Scalars are aligned to their size, as the Arrow reader verifies.
+class FlatBuilder {
+public:
+    struct Field {
+        int id;
+        size_t size;
+        uint64_t value; // little-endian bits for scalars; offsets are linked after the table is written
+    };
+
+    std::vector<uint8_t> data;
+
+    void align(size_t alignment) {
+        while (data.size() % alignment) data.push_back(0);
+    }
+
+    template <typename T>
+    size_t put(T value) {
+        align(sizeof(T));
+        size_t position = data.size();
+        data.resize(position + sizeof(T));
+        std::memcpy(&data[position], &value, sizeof(T));
+        return position;
+    }
+
+    // Points the offset field at `position` to the object at `target`
+    void link(size_t position, size_t target) {
+        uint32_t offset = static_cast<uint32_t>(target - position);
+        std::memcpy(&data[position], &offset, sizeof(offset));
+    }
+
+    // Writes a table and returns its position; fieldPositions receives where each field landed
+    size_t table(const std::vector<Field>& fields, std::vector<size_t>& fieldPositions) {
+        // Layout relative to an 8-byte aligned table start, after the 4-byte vtable offset
+        std::vector<size_t> relative;
+        size_t size = 4;
+        int slots = 0;
+        for (const auto& field : fields) {
+            size = (size + field.size - 1) / field.size * field.size;
+            relative.push_back(size);
+            size += field.size;
+            slots = std::max(slots, field.id + 1);
+        }
+
+        std::vector<uint16_t> vtable(slots, 0);
+        for (size_t i = 0; i < fields.size(); ++i) vtable[fields[i].id] = static_cast<uint16_t>(relative[i]);
+        size_t vtablePosition = put<uint16_t>(static_cast<uint16_t>(4 + 2 * slots));
+        put<uint16_t>(static_cast<uint16_t>(size));
+        for (uint16_t entry : vtable) put<uint16_t>(entry);
+
+        align(8);
+        size_t tablePosition = put<int32_t>(static_cast<int32_t>(data.size() - vtablePosition));
+        data.resize(tablePosition + size, 0);
+        fieldPositions.clear();
+        for (size_t i = 0; i < fields.size(); ++i) {
+            fieldPositions.push_back(tablePosition + relative[i]);
+            std::memcpy(&data[fieldPositions.back()], &fields[i].value, fields[i].size);
+        }
+        return tablePosition;
+    }
+
+    size_t string(const std::string& value) {
+        size_t position = put<uint32_t>(static_cast<uint32_t>(value.size()));
+        data.insert(data.end(), value.begin(), value.end());
+        data.push_back(0);
+        return position;
+    }
+
+    // Vector of inline structs; the elements after the length prefix are aligned to `alignment`
+    size_t structVector(const void* elements, size_t count, size_t elementSize, size_t alignment) {
+        align(4);
+        while ((data.size() + 4) % alignment) put<uint32_t>(0);
+        size_t position = put<uint32_t>(static_cast<uint32_t>(count));
+        const uint8_t* bytes = static_cast<const uint8_t*>(elements);
+        data.insert(data.end(), bytes, bytes + count * elementSize);
+        return position;
+    }
+
+    // Vector of offsets to tables; slots receives the offset positions to link
+    size_t offsetVector(size_t count, std::vector<size_t>& slots) {
+        size_t position = put<uint32_t>(static_cast<uint32_t>(count));
+        slots.clear();
+        for (size_t i = 0; i < count; ++i) slots.push_back(put<uint32_t>(0));
+        return position;
+    }
+};
+
+// FieldNode and Buffer structs of a record batch
+struct ArrowStruct {
+    int64_t first;
+    int64_t second;
+};
+
+void appendBuffer(std::vector<uint8_t>& body, std::vector<ArrowStruct>& buffers, const void* bytes, size_t length) {
+    buffers.push_back({static_cast<int64_t>(body.size()), static_cast<int64_t>(length)});
+    const uint8_t* begin = static_cast<const uint8_t*>(bytes);
+    body.insert(body.end(), begin, begin + length);
+    while (body.size() % 8) body.push_back(0);
+}
+
+} // namespace
+
+ArrowWriter::ArrowWriter(const std::string& filename, size_t batchSize, bool includeGap)
+    : batchSize(batchSize), includeGap(includeGap) {
+    if (batchSize == 0) {
+        throw std::invalid_argument("Arrow batch size must be greater than 0");
+    }
+    outFile.open(filename, std::ios::binary);
+    if (!outFile) {
+        throw std::runtime_error("Unable to open file: " + filename);
+    }
+
+    for (int i = 1; i <= 2; ++i) {
+        for (int v = 1; v <= 4; ++v) {
+            for (const char* axis : {"x", "y", "z"}) {
+                doubleColumns.push_back("T" + std::to_string(i) + "_v" + std::to_string(v) + "_" + axis);
+            }
+        }
+    }
+    doubleColumns.push_back("IntersectionVolume");
+    if (includeGap) doubleColumns.push_back("Gap");
+    doubles.resize(doubleColumns.size());
+
+    writeSchema();
+}
+
+ArrowWriter::~ArrowWriter() {
+    try {
+        close();
+    } catch (const std::exception& e) {
+        std::cerr << "Error closing Arrow output: " << e.what() << std::endl;
+    }
+}
+
+void ArrowWriter::close() {
+    if (!outFile.is_open()) return;
+    if (!status.empty()) writeBatch();
+
+    // End-of-stream marker: continuation token followed by a zero metadata length
+    const uint32_t endOfStream[2] = {0xFFFFFFFFu, 0};
+    outFile.write(reinterpret_cast<const char*>(endOfStream), sizeof(endOfStream));
+    outFile.close();
+}
+
+void ArrowWriter::writeEntry(const Tetrahedron& T1, const Tetrahedron& T2, double volume, bool intersects) {
+    writeRecord({T1, T2, volume, intersects, 0});
+}
+
+void ArrowWriter::writeRecord(const PairRecord& record) {
+    size_t column = 0;
+    for (const Tetrahedron* T : {&record.T1, &record.T2}) {
+        for (int i = 0; i < 4; ++i) {
+            for (int k = 0; k < 3; ++k) doubles[column++].push_back(CGAL::to_double(T->vertex(i)[k]));
+        }
+    }
+    doubles[column++].push_back(record.volume);
+    if (includeGap) doubles[column++].push_back(record.gap);
+    status.push_back(record.intersects);
+    types.push_back(static_cast<int8_t>(record.type));
+
+    if (status.size() >= batchSize) writeBatch();
+}
+
+void ArrowWriter::flush() {
+    if (!status.empty()) writeBatch();
+    for (auto& column : doubles) column.shrink_to_fit();
+    status.shrink_to_fit();
+    types.shrink_to_fit();
+}
+
+void ArrowWriter::writeSchema() {
+    FlatBuilder fb;
+    std::vector<size_t> positions, slots;
+    size_t root = fb.put<uint32_t>(0);
+
+    fb.link(root, fb.table({{0, 2, static_cast<uint64_t>(METADATA_V5)}, {1, 1, HEADER_SCHEMA}, {2, 4, 0}, {3, 8, 0}}, positions));
+    size_t header = positions[2];
+
+    fb.link(header, fb.table({{0, 2, 0}, {1, 4, 0}}, positions));
+    size_t fieldsOffset = positions[1];
+
+    // Schema order: coordinates and volume, status, type, then gap
+    std::vector<std::pair<std::string, uint8_t>> fields;
+    for (size_t i = 0; i < 25; ++i) fields.push_back({doubleColumns[i], TYPE_FLOATING_POINT});
+    fields.push_back({"HasIntersection", TYPE_BOOL});
+    fields.push_back({"IntersectionType", TYPE_INT});
+    if (includeGap) fields.push_back({"Gap", TYPE_FLOATING_POINT});
+
+    std::vector<size_t> fieldSlots;
+    fb.link(fieldsOffset, fb.offsetVector(fields.size(), fieldSlots));
+    for (size_t i = 0; i < fields.size(); ++i) {
+        const auto& [name, type] = fields[i];
+        fb.link(fieldSlots[i], fb.table({{0, 4, 0}, {1, 1, 0}, {2, 1, type}, {3, 4, 0}, {5, 4, 0}}, positions));
+        const std::vector<size_t> field = positions;
+
+        fb.link(field[0], fb.string(name));
+        if (type == TYPE_FLOATING_POINT) {
+            fb.link(field[3], fb.table({{0, 2, static_cast<uint64_t>(PRECISION_DOUBLE)}}, positions));
+        } else if (type == TYPE_INT) {
+            fb.link(field[3], fb.table({{0, 4, 8}, {1, 1, 1}}, positions));
+        } else {
+            fb.link(field[3], fb.table({}, positions));
+        }
+        fb.link(field[4], fb.offsetVector(0, slots)); // readers require the children vector
+    }
+
+    writeMessage(fb.data, {});
+}
+
+void ArrowWriter::writeBatch() {
+    const size_t rows = status.size();
+    std::vector<uint8_t> body;
+    std::vector<ArrowStruct> nodes, buffers;
+
+    // No column has nulls, so every validity buffer is empty
+    auto addColumn = [&](const void* bytes, size_t length) {
+        nodes.push_back({static_cast<int64_t>(rows), 0});
+        appendBuffer(body, buffers, nullptr, 0);
+        appendBuffer(body, buffers, bytes, length);
+    };
+
+    for (size_t i = 0; i < 25; ++i) addColumn(doubles[i].data(), rows * sizeof(double));
+
+    std::vector<uint8_t> bits((rows + 7) / 8, 0);
+    for (size_t i = 0; i < rows; ++i) {
+        if (status[i]) bits[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+    }
+    addColumn(bits.data(), bits.size());
+    addColumn(types.data(), rows);
+    if (includeGap) addColumn(doubles[25].data(), rows * sizeof(double));
+
+    FlatBuilder fb;
+    std::vector<size_t> positions;
+    size_t root = fb.put<uint32_t>(0);
+
+    fb.link(root, fb.table({{0, 2, static_cast<uint64_t>(METADATA_V5)}, {1, 1, HEADER_RECORD_BATCH}, {2, 4, 0},
+                            {3, 8, static_cast<uint64_t>(body.size())}}, positions));
+    size_t header = positions[2];
+
+    fb.link(header, fb.table({{0, 8, static_cast<uint64_t>(rows)}, {1, 4, 0}, {2, 4, 0}}, positions));
+    const std::vector<size_t> batch = positions;
+    fb.link(batch[1], fb.structVector(nodes.data(), nodes.size(), sizeof(ArrowStruct), 8));
+    fb.link(batch[2], fb.structVector(buffers.data(), buffers.size(), sizeof(ArrowStruct), 8));
+
+    writeMessage(fb.data, body);
+
+    for (auto& column : doubles) column.clear();
+    status.clear();
+    types.clear();
+}
+
+void ArrowWriter::writeMessage(const std::vector<uint8_t>& metadata, const std::vector<uint8_t>& body) {
+    // Continuation token, metadata length padded so the body starts 8-byte aligned, metadata, body
+    const uint32_t continuation = 0xFFFFFFFFu;
+    const int32_t length = static_cast<int32_t>((metadata.size() + 7) / 8 * 8);
+    const char padding[8] = {};
+
+    outFile.write(reinterpret_cast<const char*>(&continuation), sizeof(continuation));
+    outFile.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    outFile.write(reinterpret_cast<const char*>(metadata.data()), metadata.size());
+    outFile.write(padding, length - metadata.size());
+    outFile.write(reinterpret_cast<const char*>(body.data()), body.size());
+    if (!outFile) {
+        throw std::runtime_error("Failed to write Arrow stream");
+    }
+}
@@ -1,12 +1,18 @@
 #include "BaseWriter.h"
 #include "CSVWriter.h"
 #include "JSONWriter.h"
+#include "ArrowWriter.h"
 #include "OBJWriter.h"
+#include "SharedMemoryWriter.h"
+#include "ShuffleWriter.h"
+#include "CompositeWriter.h"
+#include "ChunkedWriter.h"
 
-std::string formatFilename(const std::string& extension, int number_of_entries){
+std::string formatFilename(const std::string& extension, int number_of_entries, const std::string& tag){
     std::string base_filename = "../output/tetrahedron_pair_";
+    std::string suffix_tag = tag.empty() ? "" : "_" + tag;
     if (number_of_entries < 1000) {
-        return base_filename + std::to_string(number_of_entries) + "_dataset." + extension;
+        return base_filename + std::to_string(number_of_entries) + suffix_tag + "_dataset." + extension;
     } else {
         int exponent = static_cast<int>(std::log10(number_of_entries));
         char suffix = 'k';
@@ -28,16 +34,21 @@ std::string formatFilename(const std::string& extension, int number_of_entries){
             formatted_number_str.pop_back(); // remove the decimal point as well
         }
 
-        return base_filename + formatted_number_str + suffix + "_dataset." + extension;
+        return base_filename + formatted_number_str + suffix + suffix_tag + "_dataset." + extension;
     }
 }
 
-std::unique_ptr<BaseWriter> BaseWriter::createWriter(const std::string& type, int numberOfEntries, int prec) {
-    std::string filename = formatFilename(type, numberOfEntries);
+std::unique_ptr<BaseWriter> BaseWriter::createWriter(const std::string& type, int numberOfEntries, int prec, const std::string& tag, bool includeGap, bool includeType) {
+    return createFileWriter(type, formatFilename(type, numberOfEntries, tag), prec, includeGap, includeType);
+}
+
+std::unique_ptr<BaseWriter> BaseWriter::createFileWriter(const std::string& type, const std::string& filename, int prec, bool includeGap, bool includeType) {
     if (type == "json") {
         return std::make_unique<JSONWriter>(filename);
     } else if(type == "csv") {
-        return std::make_unique<CSVWriter>(filename, prec);
+        return std::make_unique<CSVWriter>(filename, prec, includeGap, includeType);
+    } else if(type == "arrow") {
+        return std::make_unique<ArrowWriter>(filename, ArrowWriter::DEFAULT_BATCH_SIZE, includeGap);
     } else if(type == "obj"){
         std::string directory = filename.substr(0, filename.find_last_of(".")); // Remove extension
         mkdir(directory.c_str(), 0777); // Create directory with read/write permissions
@@ -46,3 +57,54 @@ std::unique_ptr<BaseWriter> BaseWriter::createWriter(const std::string& type, in
     return nullptr;
 }
 
+// A file sink for one format and split, chunked when configured
+static std::unique_ptr<BaseWriter> createSink(const Configuration& config, const std::string& type, int numberOfEntries, const std::string& tag = "") {
+    if (type == "arrow") {
+        return std::make_unique<ArrowWriter>(formatFilename(type, numberOfEntries, tag), config.getArrowBatchSize(), config.isNearMissEnabled());
+    }
+    if (config.isChunkingEnabled()) {
+        return std::make_unique<ChunkedWriter>(type, formatFilename(type, numberOfEntries, tag), config.getPrecision(),
+                                               config.getRowsPerChunk(), config.getBytesPerChunk(), config.isNearMissEnabled(),
+                                               config.isTypeColumnEnabled());
+    }
+    return BaseWriter::createWriter(type, numberOfEntries, config.getPrecision(), tag, config.isNearMissEnabled(), config.isTypeColumnEnabled());
+}
+
+std::unique_ptr<BaseWriter> BaseWriter::createWriter(const Configuration& config) {
+    std::unique_ptr<BaseWriter> writer;
+    // Top-up rows go after the existing ones, or into files tagged so the input is never overwritten
+    const std::string tag = config.isTopUpEnabled() ? "topup" : "";
+
+    if (config.isTopUpEnabled() && config.getTopUpMode() == "append") {
+        writer = std::make_unique<CSVWriter>(config.getTopUpInput(), config.getPrecision(), config.isNearMissEnabled(),
+                                              config.isTypeColumnEnabled(), true);
+    } else if (config.getOutputFormat() == "shm") {
+        writer = std::make_unique<SharedMemoryWriter>(
+            config.getSharedMemoryName(), config.getSharedMemoryCapacity(), config.getSharedMemoryMode() == "drop_oldest",
+            config.getSharedMemoryTimeout());
+    } else if (config.getOutputFormats().size() > 1 || !config.getSplits().empty()) {
+        // Fan out: one sink per format and split, each named after its expected share
+        auto composite = std::make_unique<CompositeWriter>(config.getSplitSeed());
+        auto splits = config.getSplits();
+        if (splits.empty()) splits.push_back({"", 1.0});
+
+        for (const auto& [name, ratio] : splits) {
+            std::vector<std::unique_ptr<BaseWriter>> sinks;
+            int expected_entries = static_cast<int>(std::lround(ratio * config.getDatasetSize()));
+            for (const auto& format : config.getOutputFormats()) {
+                auto sink = createSink(config, format, expected_entries, tag.empty() || name.empty() ? tag + name : tag + "_" + name);
+                if (!sink) return nullptr;
+                sinks.push_back(std::move(sink));
+            }
+            composite->addSplit(ratio, std::move(sinks));
+        }
+        writer = std::move(composite);
+    } else {
+        writer = createSink(config, config.getOutputFormat(), config.getDatasetSize(), tag);
+    }
+
+    if (writer && config.isShuffleEnabled() && config.getShuffleBufferSize() > 0) {
+        writer = std::make_unique<ShuffleWriter>(std::move(writer), config.getShuffleBufferSize(), config.getShuffleSeed());
+    }
+    return writer;
+}
@@ -2,23 +2,57 @@
 
 unsigned int MAX_VERTICES = 16;
 
-CSVWriter::CSVWriter(const std::string& filename, int prec) : BaseWriter(prec) {
-    outFile.open(filename);
+CSVWriter::CSVWriter(const std::string& filename, int prec, bool includeGap, bool includeType, bool append)
+    : BaseWriter(prec), includeGap(includeGap), includeType(includeType) {
+    // Appending continues an existing file only if its columns are the ones written here;
+    // files from before the IntersectionType column keep their layout
+    std::string existing;
+    if (append) {
+        std::ifstream inFile(filename);
+        std::getline(inFile, existing);
+        if (!existing.empty()) {
+            this->includeType = ("," + existing + ",").find(",IntersectionType,") != std::string::npos;
+        }
+    }
+    setHeaders();
+
+    if (!existing.empty()) {
+        std::string expected;
+        for (size_t i = 0; i < headers.size(); ++i) {
+            expected += (i > 0 ? "," : "") + headers[i];
+        }
+        if (existing != expected) {
+            throw std::runtime_error("Cannot append to " + filename + ": its columns differ from the configured output");
+        }
+    }
+
+    outFile.open(filename, existing.empty() ? std::ios::out : std::ios::app);
     if (!outFile) {
         throw std::runtime_error("Unable to open file: " + filename);
     }
-    setHeaders();
-    writeHeaders();
+    if (existing.empty()) writeHeaders();
 }
 
 CSVWriter::~CSVWriter() {
-    if (outFile.is_open()){
-        outFile.flush();
-        outFile.close();
+    try {
+        close();
+    } catch (const std::exception& e) {
+        std::cerr << "Error closing CSV output: " << e.what() << std::endl;
     }
 }
 
+void CSVWriter::close() {
+    if (outFile.is_open()) outFile.close();
+}
+
 void CSVWriter::writeEntry(const Tetrahedron& T1, const Tetrahedron& T2, double volume, bool intersects) {
+    writeRecord({T1, T2, volume, intersects, 0});
+}
+
+void CSVWriter::writeRecord(const PairRecord& record) {
+    const Tetrahedron& T1 = record.T1;
+    const Tetrahedron& T2 = record.T2;
+
     for (int i = 0; i < 4; ++i) {
         writeVertex(T1.vertex(i));
         outFile << ",";
@@ -52,8 +86,14 @@ void CSVWriter::writeEntry(const Tetrahedron& T1, const Tetrahedron& T2, double
     // }
     // outFile << "\","; // End of the parenthesis encapsulated string for the resulting shape and adding comma to separate next field
     
-    outFile << std::fixed << std::setprecision(precision) << volume << ",";
-    outFile << (intersects ? 1 : 0);
+    outFile << std::fixed << std::setprecision(precision) << record.volume << ",";
+    outFile << (record.intersects ? 1 : 0);
+    if (includeType) {
+        outFile << "," << record.type;
+    }
+    if (includeGap) {
+        outFile << "," << std::fixed << std::setprecision(precision) << record.gap;
+    }
     outFile << "\n";
 }
 
@@ -69,6 +109,8 @@ void CSVWriter::setHeaders() {
     // headers.push_back("intersection_class");
     headers.push_back("IntersectionVolume");
     headers.push_back("HasIntersection");
+    if (includeType) headers.push_back("IntersectionType");
+    if (includeGap) headers.push_back("Gap");
 }
 
 void CSVWriter::writeHeaders() {
@@ -0,0 +1,105 @@
+#include "ChunkedWriter.h"
+#include <cstdio>
+
+ChunkedWriter::ChunkedWriter(const std::string& type, const std::string& filename, int prec, uint64_t rowsPerChunk, uint64_t bytesPerChunk, bool includeGap, bool includeType)
+    : BaseWriter(prec), type(type), basename(filename.substr(0, filename.find_last_of("."))),
+      rowsPerChunk(rowsPerChunk), bytesPerChunk(bytesPerChunk), includeGap(includeGap), includeType(includeType) {
+    writeManifest();
+}
+
+ChunkedWriter::~ChunkedWriter() {
+    if (complete) return;
+    try {
+        close();
+    } catch (const std::exception& e) {
+        std::cerr << "Chunk finalization failed: " << e.what() << std::endl;
+    }
+}
+
+void ChunkedWriter::close() {
+    if (complete) return;
+    closeChunk();
+    complete = true;
+    writeManifest();
+}
+
+void ChunkedWriter::writeEntry(const Tetrahedron& T1, const Tetrahedron& T2, double volume, bool intersects) {
+    writeRecord({T1, T2, volume, intersects, 0});
+}
+
+void ChunkedWriter::writeRecord(const PairRecord& record) {
+    if (!writer) openChunk();
+
+    writer->writeRecord(record);
+    current.rows++;
+    if (record.type >= 1 && record.type <= 5) current.rowsPerType[record.type - 1]++;
+
+    bool rowsFull = rowsPerChunk > 0 && current.rows >= rowsPerChunk;
+    bool bytesFull = bytesPerChunk > 0 && writer->bytesWritten() >= bytesPerChunk;
+    if (rowsFull || bytesFull) closeChunk();
+}
+
+void ChunkedWriter::flush() {
+    if (writer) writer->flush();
+}
+
+void ChunkedWriter::openChunk() {
+    std::stringstream ss;
+    ss << basename << ".part-" << std::setw(5) << std::setfill('0') << chunks.size() << "." << type;
+
+    current = Chunk();
+    current.filename = ss.str();
+    writer = createFileWriter(type, current.filename, precision, includeGap, includeType);
+    if (!writer) {
+        throw std::runtime_error("Chunked output does not support format: " + type);
+    }
+}
+
+void ChunkedWriter::closeChunk() {
+    if (!writer) return;
+
+    // The chunk was checksummed as it was written, so it is not read back
+    writer->close();
+    if (!writer->checksum(current.crc, current.bytes)) {
+        throw std::logic_error("Chunked output needs OutputFile::setChecksums");
+    }
+    writer.reset();
+    chunks.push_back(current);
+    writeManifest();
+}
+
+void ChunkedWriter::writeManifest() const {
+    json manifest;
+    manifest["format"] = type;
+    manifest["complete"] = complete;
+
+    uint64_t totalRows = 0;
+    manifest["chunks"] = json::array();
+    for (const auto& chunk : chunks) {
+        std::stringstream crc;
+        crc << std::hex << std::setw(8) << std::setfill('0') << chunk.crc;
+
+        json entry;
+        entry["file"] = chunk.filename.substr(chunk.filename.find_last_of("/") + 1);
+        entry["rows"] = chunk.rows;
+        entry["bytes"] = chunk.bytes;
+        entry["crc32"] = crc.str();
+        entry["rows_per_type"] = chunk.rowsPerType;
+        manifest["chunks"].push_back(entry);
+        totalRows += chunk.rows;
+    }
+    manifest["total_rows"] = totalRows;
+
+    // Replace the manifest atomically so readers never see a partial one
+    std::string filename = basename + ".manifest.json";
+    {
+        std::ofstream outFile(filename + ".tmp");
+        if (!outFile) {
+            throw std::runtime_error("Unable to open file: " + filename + ".tmp");
+        }
+        outFile << manifest.dump(4);
+    }
+    if (std::rename((filename + ".tmp").c_str(), filename.c_str()) != 0) {
+        throw std::runtime_error("Unable to write manifest: " + filename);
+    }
+}
@@ -0,0 +1,45 @@
+#include "CompositeWriter.h"
+
+CompositeWriter::CompositeWriter(uint64_t seed) : seed(seed) {}
+
+void CompositeWriter::addSplit(double ratio, std::vector<std::unique_ptr<BaseWriter>> sinks) {
+    double previous = cumulativeRatios.empty() ? 0.0 : cumulativeRatios.back();
+    cumulativeRatios.push_back(previous + ratio);
+    splits.push_back(std::move(sinks));
+}
+
+void CompositeWriter::writeEntry(const Tetrahedron& T1, const Tetrahedron& T2, double volume, bool intersects) {
+    writeRecord({T1, T2, volume, intersects, 0});
+}
+
+void CompositeWriter::writeRecord(const PairRecord& record) {
+    for (auto& sink : splits[selectSplit()]) {
+        sink->writeRecord(record);
+    }
+}
+
+void CompositeWriter::flush() {
+    for (auto& split : splits) {
+        for (auto& sink : split) sink->flush();
+    }
+}
+
+void CompositeWriter::close() {
+    for (auto& split : splits) {
+        for (auto& sink : split) sink->close();
+    }
+}
+
+size_t CompositeWriter::selectSplit() {
+    // SplitMix64 of (seed, index): the assignment of a record index never depends on the sinks
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (++recordIndex);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+
+    double u = (z >> 11) * 0x1.0p-53 * cumulativeRatios.back();
+    for (size_t i = 0; i < cumulativeRatios.size(); ++i) {
+        if (u < cumulativeRatios[i]) return i;
+    }
+    return cumulativeRatios.size() - 1;
+}
@@ -1,4 +1,6 @@
 #include "Config.h"
+#include "GridGeometry.h"
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <cmath>
@@ -19,34 +21,387 @@ void Configuration::loadConfig(const std::string& config_path) {
     config_file >> j;
 
     output_format = j["output_format"]["value"].get<std::string>();
+    output_formats = {output_format};
     precision = j["precision"]["value"].get<int>();
+    if (j.contains("type_column")) {
+        type_column = j["type_column"]["value"].get<bool>();
+    }
     dataset_size = j["dataset_size"]["value"].get<int>();
     intersection_distribution = j["intersection_distribution"]["value"].get<std::vector<double>>();
     volume_min = j["volume_range"]["value"]["min"].get<double>();
     volume_max = j["volume_range"]["value"]["max"].get<double>();
     num_bins = j["num_bins"]["value"].get<int>();
-}
 
-void Configuration::validateConfig() {
-    if (precision < 1 || precision > 16) {
-        throw std::invalid_argument("Precision must be between 1 and 16");
+    if (j.contains("seed")) {
+        seed = j["seed"]["value"].get<unsigned int>();
     }
 
-    if (dataset_size <= 0) {
-        throw std::invalid_argument("Dataset size must be greater than 0");
+    if (j.contains("coordinate_grid")) {
+        grid_enabled = j["coordinate_grid"]["value"]["enabled"].get<bool>();
+        grid_bits = j["coordinate_grid"]["value"]["bits"].get<int>();
+    }
+
+    if (j.contains("output_sinks")) {
+        auto formats = j["output_sinks"]["value"]["formats"].get<std::vector<std::string>>();
+        if (!formats.empty()) {
+            output_formats = formats;
+            output_format = formats.front();
+        }
+        for (const auto& split : j["output_sinks"]["value"]["splits"]) {
+            splits.push_back({split["name"].get<std::string>(), split["ratio"].get<double>()});
+        }
+        split_seed = j["output_sinks"]["value"]["seed"].get<uint64_t>();
+    }
+
+    if (j.contains("shared_memory")) {
+        shm_name = j["shared_memory"]["value"]["name"].get<std::string>();
+        shm_capacity = j["shared_memory"]["value"]["capacity"].get<uint64_t>();
+        shm_mode = j["shared_memory"]["value"]["mode"].get<std::string>();
+        if (j["shared_memory"]["value"].contains("timeout_seconds")) {
+            shm_timeout = j["shared_memory"]["value"]["timeout_seconds"].get<double>();
+        }
+    }
+
+    if (j.contains("near_miss")) {
+        near_miss_enabled = j["near_miss"]["value"]["enabled"].get<bool>();
+        near_miss_fraction = j["near_miss"]["value"]["fraction"].get<double>();
+        near_miss_gap_min = j["near_miss"]["value"]["gap_min"].get<double>();
+        near_miss_gap_max = j["near_miss"]["value"]["gap_max"].get<double>();
+    }
+
+    if (j.contains("containment")) {
+        containment_enabled = j["containment"]["value"]["enabled"].get<bool>();
+        containment_from_volume = j["containment"]["value"]["from_volume"].get<double>();
+        containment_fraction = j["containment"]["value"]["fraction"].get<double>();
+    }
+
+    if (j.contains("prefilter")) {
+        prefilter_enabled = j["prefilter"]["value"]["enabled"].get<bool>();
+        prefilter_stages = j["prefilter"]["value"]["stages"].get<std::vector<std::string>>();
+        prefilter_tolerance = j["prefilter"]["value"]["tolerance"].get<double>();
     }
 
-    if (intersection_distribution.size() != 5) {
+    if (j.contains("top_up")) {
+        top_up_enabled = j["top_up"]["value"]["enabled"].get<bool>();
+        top_up_input = j["top_up"]["value"]["input_file"].get<std::string>();
+        top_up_mode = j["top_up"]["value"]["mode"].get<std::string>();
+    }
+
+    if (j.contains("arrow")) {
+        arrow_batch_size = j["arrow"]["value"]["batch_size"].get<size_t>();
+    }
+
+    if (j.contains("compression")) {
+        compression_format = j["compression"]["value"]["format"].get<std::string>();
+        compression_level = j["compression"]["value"]["level"].get<int>();
+    }
+
+    if (j.contains("async_output")) {
+        async_output_enabled = j["async_output"]["value"]["enabled"].get<bool>();
+        async_output_block_mb = j["async_output"]["value"]["block_mb"].get<int>();
+        async_output_blocks = j["async_output"]["value"]["blocks"].get<int>();
+        async_output_direct = j["async_output"]["value"]["direct"].get<bool>();
+    }
+
+    if (j.contains("statistics")) {
+        statistics_enabled = j["statistics"]["value"]["enabled"].get<bool>();
+        statistics_histogram_bins = j["statistics"]["value"]["histogram_bins"].get<int>();
+    }
+
+    if (j.contains("label_shortcut")) {
+        label_shortcut_enabled = j["label_shortcut"]["value"]["enabled"].get<bool>();
+        label_audit_rate = j["label_shortcut"]["value"]["audit_rate"].get<double>();
+    }
+
+    if (j.contains("time_budget")) {
+        time_budget_enabled = j["time_budget"]["value"]["enabled"].get<bool>();
+        time_budget_seconds = j["time_budget"]["value"]["seconds"].get<double>();
+    }
+
+    if (j.contains("memory")) {
+        memory_enabled = j["memory"]["value"]["enabled"].get<bool>();
+        memory_sample_interval = j["memory"]["value"]["sample_interval"].get<int>();
+        memory_ceiling_mb = j["memory"]["value"]["ceiling_mb"].get<double>();
+    }
+
+    if (j.contains("parallel")) {
+        parallel_threads = j["parallel"]["value"]["threads"].get<int>();
+        parallel_slice_size = j["parallel"]["value"]["slice_size"].get<int>();
+    }
+
+    if (j.contains("scene")) {
+        scene_enabled = j["scene"]["value"]["enabled"].get<bool>();
+        scene_count = j["scene"]["value"]["scenes"].get<int>();
+        scene_tetrahedra = j["scene"]["value"]["tetrahedra"].get<int>();
+        scene_scale = j["scene"]["value"]["scale"].get<double>();
+        scene_narrow_phase = j["scene"]["value"]["narrow_phase"].get<std::string>();
+    }
+
+    if (j.contains("server")) {
+        server_enabled = j["server"]["value"]["enabled"].get<bool>();
+        server_socket_path = j["server"]["value"]["socket_path"].get<std::string>();
+        server_batch_size = j["server"]["value"]["batch_size"].get<int>();
+        server_max_pairs_per_client = j["server"]["value"]["max_pairs_per_client"].get<uint64_t>();
+    }
+
+    if (j.contains("batch_generation")) {
+        batch_enabled = j["batch_generation"]["value"]["enabled"].get<bool>();
+        batch_size = j["batch_generation"]["value"]["batch_size"].get<int>();
+        min_abs_determinant = j["batch_generation"]["value"]["min_abs_determinant"].get<double>();
+    }
+
+    if (j.contains("chunking")) {
+        chunking_enabled = j["chunking"]["value"]["enabled"].get<bool>();
+        rows_per_chunk = j["chunking"]["value"]["rows_per_chunk"].get<uint64_t>();
+        bytes_per_chunk = j["chunking"]["value"]["bytes_per_chunk"].get<uint64_t>();
+    }
+
+    if (j.contains("shuffle")) {
+        shuffle_enabled = j["shuffle"]["value"]["enabled"].get<bool>();
+        shuffle_buffer_size = j["shuffle"]["value"]["buffer_size"].get<int>();
+        shuffle_seed = j["shuffle"]["value"]["seed"].get<unsigned int>();
+    }
+}
+
+void Configuration::validateTargets(const std::vector<double>& distribution, double volume_min, double volume_max, int num_bins) {
+    if (distribution.size() != 5) {
         throw std::invalid_argument("Intersection distribution must have exactly 5 values");
     }
 
-    if (volume_min < 0 || volume_max > 0.333333333333333 || volume_min >= volume_max) {
+    double sum = 0;
+    for (double share : distribution) {
+        if (!(share >= 0)) {
+            throw std::invalid_argument("Intersection distribution values must be non-negative");
+        }
+        sum += share;
+    }
+    if (std::abs(sum - 100.0) > 1.0) {
+        throw std::invalid_argument("Intersection distribution must sum to 100");
+    }
+
+    // No tetrahedron in the unit cube encloses more than a third of it
+    if (!(volume_min >= 0) || volume_max > 0.333333333333333 || !(volume_min < volume_max)) {
         throw std::invalid_argument("Invalid volume range");
     }
 
     if (num_bins <= 0) {
         throw std::invalid_argument("Number of bins must be greater than 0");
     }
+}
+
+void Configuration::validateConfig() {
+    // Grid values k / 2^bits print exactly with `bits` decimal places, so the grid needs up to MAX_BITS
+    const int max_precision = grid_enabled ? GridGeometry::MAX_BITS : 16;
+    if (precision < 1 || precision > max_precision) {
+        throw std::invalid_argument("Precision must be between 1 and 16, or " + std::to_string(GridGeometry::MAX_BITS) +
+                                    " with the coordinate grid");
+    }
+
+    if (dataset_size <= 0) {
+        throw std::invalid_argument("Dataset size must be greater than 0");
+    }
+
+    validateTargets(intersection_distribution, volume_min, volume_max, num_bins);
+
+    if (output_formats.size() > 1 || !splits.empty()) {
+        for (const auto& format : output_formats) {
+            if (format != "csv" && format != "json" && format != "obj" && format != "arrow") {
+                throw std::invalid_argument("Fan-out output format must be csv, json, obj or arrow: " + format);
+            }
+        }
+
+        double ratio_sum = 0;
+        for (size_t i = 0; i < splits.size(); ++i) {
+            if (splits[i].first.empty() || splits[i].second <= 0) {
+                throw std::invalid_argument("Each split needs a name and a positive ratio");
+            }
+            for (size_t k = 0; k < i; ++k) {
+                if (splits[k].first == splits[i].first) {
+                    throw std::invalid_argument("Duplicate split name: " + splits[i].first);
+                }
+            }
+            ratio_sum += splits[i].second;
+        }
+        if (!splits.empty() && std::abs(ratio_sum - 1.0) > 1e-6) {
+            throw std::invalid_argument("Split ratios must sum to 1");
+        }
+    }
+
+    if (output_format == "shm") {
+        if (shm_name.empty() || shm_name[0] != '/') {
+            throw std::invalid_argument("Shared memory name must start with '/'");
+        }
+        if (shm_capacity == 0 || (shm_capacity & (shm_capacity - 1)) != 0) {
+            throw std::invalid_argument("Shared memory capacity must be a power of two");
+        }
+        if (shm_mode != "blocking" && shm_mode != "drop_oldest") {
+            throw std::invalid_argument("Shared memory mode must be 'blocking' or 'drop_oldest'");
+        }
+        if (!(shm_timeout >= 0)) {
+            throw std::invalid_argument("Shared memory timeout must be non-negative");
+        }
+    }
+
+    if (near_miss_enabled) {
+        if (near_miss_fraction < 0 || near_miss_fraction > 1) {
+            throw std::invalid_argument("Near-miss fraction must be between 0 and 1");
+        }
+        if (near_miss_gap_min <= 0 || near_miss_gap_max < near_miss_gap_min || near_miss_gap_max >= 1) {
+            throw std::invalid_argument("Invalid near-miss gap range");
+        }
+    }
+
+    if (containment_enabled) {
+        if (containment_fraction < 0 || containment_fraction > 1) {
+            throw std::invalid_argument("Containment fraction must be between 0 and 1");
+        }
+        if (containment_from_volume < volume_min || containment_from_volume >= volume_max) {
+            throw std::invalid_argument("Containment from_volume must lie within the volume range");
+        }
+    }
+
+    if (prefilter_enabled) {
+        for (const auto& stage : prefilter_stages) {
+            // The clip estimate is not a bound, so it could reject candidates that belong in an open bin
+            if (stage == "estimate") {
+                throw std::invalid_argument("Pre-filter stage 'estimate' is not a rigorous bound; use 'volume' and 'bbox'");
+            }
+            if (stage != "volume" && stage != "bbox") {
+                throw std::invalid_argument("Pre-filter stages must be 'volume' or 'bbox'");
+            }
+        }
+        if (prefilter_tolerance < 0) {
+            throw std::invalid_argument("Pre-filter tolerance must be non-negative");
+        }
+    }
+
+    if (top_up_enabled) {
+        if (top_up_input.empty()) {
+            throw std::invalid_argument("Top-up needs the input_file of an existing CSV dataset");
+        }
+        if (top_up_mode != "append" && top_up_mode != "new") {
+            throw std::invalid_argument("Top-up mode must be 'append' or 'new'");
+        }
+        if (top_up_mode == "append" && (output_format != "csv" || output_formats.size() > 1 || !splits.empty() || chunking_enabled)) {
+            throw std::invalid_argument("Appending a top-up needs a single unchunked csv output");
+        }
+    }
+
+    if (arrow_batch_size == 0) {
+        throw std::invalid_argument("Arrow batch size must be greater than 0");
+    }
+
+    if (compression_format != "none" && compression_format != "gzip") {
+        throw std::invalid_argument("Compression format must be 'none' or 'gzip'");
+    }
+    if (compression_format == "gzip") {
+        if (compression_level < 1 || compression_level > 9) {
+            throw std::invalid_argument("Compression level must be between 1 and 9");
+        }
+        if (std::find(output_formats.begin(), output_formats.end(), "obj") != output_formats.end()) {
+            throw std::invalid_argument("OBJ output is a directory of files and cannot be compressed");
+        }
+        if (chunking_enabled || (top_up_enabled && top_up_mode == "append")) {
+            throw std::invalid_argument("Compressed output cannot be chunked or appended to");
+        }
+    }
+
+    if (async_output_enabled) {
+        if (async_output_block_mb <= 0 || async_output_blocks < 2) {
+            throw std::invalid_argument("Asynchronous output needs blocks of at least 1 MB and at least 2 blocks");
+        }
+        // The gzip stream already writes from its own thread
+        if (compression_format == "gzip") {
+            throw std::invalid_argument("Asynchronous output only applies to uncompressed files");
+        }
+    }
+
+    if (statistics_enabled && statistics_histogram_bins <= 0) {
+        throw std::invalid_argument("Statistics histogram bins must be greater than 0");
+    }
+
+    if (label_shortcut_enabled && (label_audit_rate < 0 || label_audit_rate > 1)) {
+        throw std::invalid_argument("Label audit rate must be between 0 and 1");
+    }
+
+    if (parallel_threads < 0 || parallel_slice_size <= 0) {
+        throw std::invalid_argument("Parallel generation needs a non-negative thread count and a positive slice size");
+    }
+
+    if (time_budget_enabled) {
+        if (time_budget_seconds <= 0) {
+            throw std::invalid_argument("Time budget must be greater than 0 seconds");
+        }
+        // Slices of the parallel scheduler are per type, so only the sequential loop interleaves
+        if (parallel_threads != 1) {
+            throw std::invalid_argument("Time budget needs parallel.threads of 1");
+        }
+    }
+
+    if (memory_enabled && (memory_sample_interval <= 0 || memory_ceiling_mb < 0)) {
+        throw std::invalid_argument("Memory monitoring needs a positive sample interval and a non-negative ceiling");
+    }
+
+    if (scene_enabled) {
+        if (scene_count <= 0 || scene_tetrahedra < 2) {
+            throw std::invalid_argument("Scene mode needs at least one scene of at least two tetrahedra");
+        }
+        if (!(scene_scale > 0 && scene_scale <= 1)) {
+            throw std::invalid_argument("Scene scale must be greater than 0 and at most 1");
+        }
+        if (scene_narrow_phase != "exact" && scene_narrow_phase != "estimate") {
+            throw std::invalid_argument("Scene narrow phase must be exact or estimate");
+        }
+        if (top_up_enabled) {
+            throw std::invalid_argument("Scene mode cannot top up a pair dataset");
+        }
+    }
+
+    if (server_enabled) {
+        if (server_socket_path.empty() || server_batch_size <= 0) {
+            throw std::invalid_argument("Server needs a socket path and a positive batch size");
+        }
+        if (scene_enabled || top_up_enabled) {
+            throw std::invalid_argument("Server mode cannot be combined with scenes or top-up");
+        }
+    }
+
+    if (batch_enabled && (batch_size <= 0 || min_abs_determinant < 0)) {
+        throw std::invalid_argument("Batch generation needs a positive batch size and a non-negative determinant threshold");
+    }
+
+    if (chunking_enabled) {
+        if (rows_per_chunk == 0 && bytes_per_chunk == 0) {
+            throw std::invalid_argument("Chunking needs rows_per_chunk or bytes_per_chunk");
+        }
+        for (const auto& format : output_formats) {
+            if (format != "csv" && format != "json") {
+                throw std::invalid_argument("Chunked output supports csv and json only");
+            }
+        }
+    }
+
+    if (shuffle_enabled && shuffle_buffer_size < 0) {
+        throw std::invalid_argument("Shuffle buffer size must not be negative");
+    }
+
+    if (grid_enabled) {
+        if (grid_bits < 1 || grid_bits > GridGeometry::MAX_BITS) {
+            throw std::invalid_argument("Coordinate grid bits must be between 1 and " + std::to_string(GridGeometry::MAX_BITS));
+        }
+        // k / 2^bits has exactly `bits` decimal places, so the written values are the grid values
+        if (grid_bits > precision) {
+            throw std::invalid_argument("Coordinate grid bits must not exceed precision");
+        }
+        // Contact constructions project onto faces and do not land on the grid
+        if (intersection_distribution[1] != 0 || intersection_distribution[2] != 0 || intersection_distribution[3] != 0) {
+            throw std::invalid_argument("Coordinate grid only supports intersection types 1 and 5");
+        }
+        // Near-miss T2 is placed at a chosen gap along a face normal, off the grid
+        if (near_miss_enabled) {
+            throw std::invalid_argument("Coordinate grid cannot be combined with near_miss");
+        }
+    }
 
     double sum = 0;
     for (double d : intersection_distribution) {
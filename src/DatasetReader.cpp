@@ -0,0 +1,78 @@
+#include "DatasetReader.h"
+#include "GeometryUtils.h"
+#include <algorithm>
+
+DatasetReader::DatasetReader(const std::string& filename) {
+    inFile.open(filename);
+    if (!inFile) {
+        throw std::runtime_error("Unable to open file: " + filename);
+    }
+
+    std::string header;
+    if (!std::getline(inFile, header)) {
+        throw std::runtime_error("Missing header in dataset: " + filename);
+    }
+    std::stringstream ss(header);
+    std::string name;
+    while (std::getline(ss, name, ',')) headers.push_back(name);
+
+    volumeColumn = column("IntersectionVolume");
+    intersectsColumn = column("HasIntersection");
+    typeColumn = column("IntersectionType");
+    gapColumn = column("Gap");
+    if (headers.size() < 24 || volumeColumn < 0 || intersectsColumn < 0) {
+        throw std::runtime_error("Not a tetrahedron pair dataset: " + filename);
+    }
+}
+
+int DatasetReader::column(const std::string& name) const {
+    auto it = std::find(headers.begin(), headers.end(), name);
+    return it == headers.end() ? -1 : static_cast<int>(it - headers.begin());
+}
+
+bool DatasetReader::next(PairRecord& record) {
+    std::string row;
+    if (!std::getline(inFile, row) || row.empty()) return false;
+    ++line;
+
+    std::vector<double> values;
+    values.reserve(headers.size());
+    const char* cursor = row.c_str();
+    while (true) {
+        char* end;
+        values.push_back(std::strtod(cursor, &end));
+        if (end == cursor) {
+            throw std::runtime_error("Malformed value on line " + std::to_string(line));
+        }
+        if (*end != ',') break;
+        cursor = end + 1;
+    }
+    if (values.size() != headers.size()) {
+        throw std::runtime_error("Expected " + std::to_string(headers.size()) + " columns on line " + std::to_string(line));
+    }
+
+    Point vertices[8];
+    for (int i = 0; i < 8; ++i) {
+        vertices[i] = Point(values[3 * i], values[3 * i + 1], values[3 * i + 2]);
+    }
+    record.T1 = Tetrahedron(vertices[0], vertices[1], vertices[2], vertices[3]);
+    record.T2 = Tetrahedron(vertices[4], vertices[5], vertices[6], vertices[7]);
+    record.volume = values[volumeColumn];
+    record.intersects = values[intersectsColumn] != 0;
+    record.gap = gapColumn >= 0 ? values[gapColumn] : 0.0;
+    record.type = typeColumn >= 0 ? static_cast<int>(values[typeColumn]) : inferType(record);
+    return true;
+}
+
+int DatasetReader::inferType(const PairRecord& record) {
+    if (!record.intersects) return 1;
+    if (record.volume > 0) return 5;
+
+    // Contact pairs carry no volume; classify the rounded geometry, which is exact for grid datasets only
+    switch (GeometryUtils::getIntersectionClassification(record.T1, record.T2)) {
+        case IntersectionType::Point: return 2;
+        case IntersectionType::Segment: return 3;
+        case IntersectionType::Polygon: return 4;
+        default: return 5;
+    }
+}
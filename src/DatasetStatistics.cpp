@@ -0,0 +1,137 @@
+#include "DatasetStatistics.h"
+#include "GeometryUtils.h"
+
+void RunningMoments::add(double value) {
+    count++;
+    double delta = value - mean;
+    mean += delta / count;
+    m2 += delta * (value - mean);
+    min = std::min(min, value);
+    max = std::max(max, value);
+}
+
+void RunningMoments::merge(const RunningMoments& other) {
+    if (other.count == 0) return;
+    if (count == 0) {
+        *this = other;
+        return;
+    }
+
+    // Chan et al. pairwise update
+    uint64_t total = count + other.count;
+    double delta = other.mean - mean;
+    mean += delta * other.count / total;
+    m2 += other.m2 + delta * delta * (static_cast<double>(count) * other.count / total);
+    count = total;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+}
+
+json RunningMoments::toJson() const {
+    json result;
+    result["count"] = count;
+    if (count == 0) return result;
+    result["mean"] = mean;
+    result["variance"] = count > 1 ? m2 / (count - 1) : 0.0;
+    result["min"] = min;
+    result["max"] = max;
+    return result;
+}
+
+DatasetStatistics::DatasetStatistics(double histogram_min, double histogram_max, int histogram_bins, bool include_gap)
+    : histogram_min(histogram_min), histogram_max(histogram_max), include_gap(include_gap), histogram(histogram_bins, 0) {
+    if (histogram_bins <= 0 || histogram_max <= histogram_min) {
+        throw std::invalid_argument("Statistics histogram needs a positive number of bins over a non-empty range");
+    }
+}
+
+double DatasetStatistics::quality(const Tetrahedron& T) {
+    double squared_edges = 0.0;
+    for (int i = 0; i < 4; ++i) {
+        for (int j = i + 1; j < 4; ++j) {
+            for (int k = 0; k < 3; ++k) {
+                double d = CGAL::to_double(T.vertex(i)[k]) - CGAL::to_double(T.vertex(j)[k]);
+                squared_edges += d * d;
+            }
+        }
+    }
+    double rms_edge = std::sqrt(squared_edges / 6.0);
+    return rms_edge > 0 ? 6.0 * std::sqrt(2.0) * GeometryUtils::approximateVolume(T) / (rms_edge * rms_edge * rms_edge) : 0.0;
+}
+
+void DatasetStatistics::add(const PairRecord& record) {
+    rows++;
+    if (record.type >= 1 && record.type <= 5) rows_per_type[record.type - 1]++;
+    if (record.intersects) intersecting++;
+
+    for (const Tetrahedron* T : {&record.T1, &record.T2}) {
+        for (int i = 0; i < 4; ++i) {
+            for (int k = 0; k < 3; ++k) coordinates[k].add(CGAL::to_double(T->vertex(i)[k]));
+        }
+        tetrahedron_volume.add(GeometryUtils::approximateVolume(*T));
+        tetrahedron_quality.add(quality(*T));
+    }
+
+    if (!record.intersects) {
+        if (include_gap) gap.add(record.gap);
+    } else if (record.volume > 0) {
+        intersection_volume.add(record.volume);
+        if (record.volume < histogram_min) {
+            histogram_underflow++;
+        } else if (record.volume >= histogram_max) {
+            histogram_overflow++;
+        } else {
+            size_t bin = static_cast<size_t>((record.volume - histogram_min) / (histogram_max - histogram_min) * histogram.size());
+            histogram[std::min(bin, histogram.size() - 1)]++;
+        }
+    }
+}
+
+void DatasetStatistics::merge(const DatasetStatistics& other) {
+    if (other.histogram.size() != histogram.size() || other.histogram_min != histogram_min || other.histogram_max != histogram_max) {
+        throw std::invalid_argument("Cannot merge statistics with different histograms");
+    }
+    if (other.include_gap != include_gap) {
+        throw std::invalid_argument("Cannot merge statistics with and without gaps");
+    }
+
+    rows += other.rows;
+    intersecting += other.intersecting;
+    for (size_t i = 0; i < rows_per_type.size(); ++i) rows_per_type[i] += other.rows_per_type[i];
+    for (size_t k = 0; k < coordinates.size(); ++k) coordinates[k].merge(other.coordinates[k]);
+    intersection_volume.merge(other.intersection_volume);
+    tetrahedron_volume.merge(other.tetrahedron_volume);
+    tetrahedron_quality.merge(other.tetrahedron_quality);
+    gap.merge(other.gap);
+    for (size_t i = 0; i < histogram.size(); ++i) histogram[i] += other.histogram[i];
+    histogram_underflow += other.histogram_underflow;
+    histogram_overflow += other.histogram_overflow;
+}
+
+json DatasetStatistics::toJson() const {
+    json result;
+    result["rows"] = rows;
+    result["intersecting_rows"] = intersecting;
+    result["rows_per_type"] = rows_per_type;
+    result["coordinates"] = {{"x", coordinates[0].toJson()}, {"y", coordinates[1].toJson()}, {"z", coordinates[2].toJson()}};
+    result["intersection_volume"] = intersection_volume.toJson();
+    result["tetrahedron_volume"] = tetrahedron_volume.toJson();
+    result["tetrahedron_quality"] = tetrahedron_quality.toJson();
+    if (include_gap) result["gap"] = gap.toJson();
+    result["volume_histogram"] = {
+        {"min", histogram_min},
+        {"max", histogram_max},
+        {"counts", histogram},
+        {"underflow", histogram_underflow},
+        {"overflow", histogram_overflow}
+    };
+    return result;
+}
+
+void DatasetStatistics::write(const std::string& filename) const {
+    std::ofstream outFile(filename);
+    if (!outFile) {
+        throw std::runtime_error("Unable to open file: " + filename);
+    }
+    outFile << toJson().dump(4);
+}
@@ -0,0 +1,416 @@
+#include "GeneratorServer.h"
+#include "TetrahedronFactory.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <random>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+std::atomic<bool> GeneratorServer::stop_requested{false};
+
+struct GeneratorServer::Request {
+    uint64_t id;
+    unsigned int seed;
+    int count;
+    std::unique_ptr<PairGenerator> generator;
+    std::atomic<int> pending_batches{0};
+    std::atomic<bool> answered{false};
+    std::atomic<bool> failed{false};
+    std::chrono::steady_clock::time_point received;
+};
+
+struct GeneratorServer::Job {
+    std::shared_ptr<Request> request;
+    int index;
+    std::vector<std::pair<int, int>> items; // (type, bin) of each record in the batch
+};
+
+struct GeneratorServer::Client {
+    int fd;
+    int wake_fd; // eventfd signalled whenever a frame is queued
+    std::mutex write_mutex;
+    std::deque<std::string> outbox; // frames not sent yet, guarded by write_mutex
+    size_t sent = 0;                // bytes of the first frame already sent
+    std::atomic<size_t> outbox_bytes{0};
+    std::deque<Job> jobs; // guarded by queue_mutex
+    uint64_t pairs_requested = 0;
+    std::atomic<bool> closed{false};
+    std::atomic<bool> finished{false};
+
+    explicit Client(int fd) : fd(fd), wake_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {}
+    ~Client() {
+        close(fd);
+        if (wake_fd >= 0) close(wake_fd);
+    }
+};
+
+// Seed of one batch of a request. seed_seq mixes both values, so requests with nearby seeds
+// do not share batches the way seed + index would.
+static unsigned int batchSeed(unsigned int seed, int index) {
+    std::seed_seq sequence{seed, static_cast<unsigned int>(index)};
+    uint32_t result;
+    sequence.generate(&result, &result + 1);
+    return result;
+}
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+GeneratorServer::GeneratorServer(const Configuration& config, int threads)
+    : config(config), threads(threads), batch_size(config.getServerBatchSize()),
+      max_pairs_per_client(config.getServerMaxPairsPerClient()),
+      outbox_limit(MAX_QUEUED_BATCHES * (sizeof(ServerFrameHeader) + batch_size * sizeof(ServerRecord))) {
+    if (threads <= 0) {
+        throw std::invalid_argument("Server needs at least one worker thread");
+    }
+}
+
+GeneratorServer::~GeneratorServer() {
+    if (listen_fd >= 0) close(listen_fd);
+}
+
+void GeneratorServer::stop() {
+    stop_requested = true;
+}
+
+void GeneratorServer::run() {
+    const std::string& path = config.getServerSocketPath();
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Socket path too long: " + path);
+    }
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        throw std::runtime_error("Unable to create socket");
+    }
+    // Replace a socket left behind by a previous run
+    unlink(path.c_str());
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listen_fd, 64) != 0) {
+        throw std::runtime_error("Unable to listen on socket: " + path);
+    }
+
+    started = std::chrono::steady_clock::now();
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back(&GeneratorServer::workLoop, this);
+    }
+    std::cout << "Serving on " << path << " with " << threads << " workers" << std::endl;
+
+    while (!stop_requested) {
+        pollfd listener{listen_fd, POLLIN, 0};
+        if (poll(&listener, 1, 200) <= 0) continue;
+
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) continue;
+
+        // Forget connections that have ended before tracking the new one
+        connections.remove_if([](std::pair<std::shared_ptr<Client>, std::thread>& connection) {
+            if (!connection.first->finished) return false;
+            connection.second.join();
+            return true;
+        });
+        auto client = std::make_shared<Client>(fd);
+        if (client->wake_fd < 0) continue;
+        connections.emplace_back(client, std::thread(&GeneratorServer::serveClient, this, client));
+        Metrics::increment("server.connections");
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        stopping = true;
+    }
+    queue_changed.notify_all();
+    for (auto& worker : workers) worker.join();
+    workers.clear();
+
+    for (auto& connection : connections) {
+        connection.first->closed = true;
+        shutdown(connection.first->fd, SHUT_RDWR);
+        connection.second.join();
+    }
+    connections.clear();
+
+    close(listen_fd);
+    listen_fd = -1;
+    unlink(path.c_str());
+    Metrics::set("server", statistics());
+}
+
+void GeneratorServer::serveClient(const std::shared_ptr<Client>& client) {
+    // This thread alone uses the socket: it reads requests and sends queued frames whenever the
+    // client can take them, so no worker ever waits for a reader
+    fcntl(client->fd, F_SETFL, fcntl(client->fd, F_GETFL) | O_NONBLOCK);
+    std::string buffer;
+    char chunk[4096];
+    while (!client->closed) {
+        pollfd fds[2] = {{client->fd, POLLIN, 0}, {client->wake_fd, POLLIN, 0}};
+        if (client->outbox_bytes > 0) fds[0].events |= POLLOUT;
+        if (poll(fds, 2, 200) < 0 && errno != EINTR) break;
+
+        if (fds[1].revents & POLLIN) {
+            uint64_t signals;
+            ssize_t cleared = read(client->wake_fd, &signals, sizeof(signals));
+            (void)cleared;
+        }
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            ssize_t received = recv(client->fd, chunk, sizeof(chunk), 0);
+            if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) break;
+            if (received > 0) buffer.append(chunk, received);
+
+            size_t end;
+            while ((end = buffer.find('\n')) != std::string::npos) {
+                std::string line = buffer.substr(0, end);
+                buffer.erase(0, end + 1);
+                if (line.find_first_not_of(" \t\r") != std::string::npos) handleRequest(client, line);
+            }
+        }
+        if (!sendQueued(*client)) break;
+    }
+
+    // Batches still queued for a client that went away are dropped
+    client->closed = true;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        client->jobs.clear();
+        ready.erase(std::remove(ready.begin(), ready.end(), client), ready.end());
+    }
+    client->finished = true;
+}
+
+void GeneratorServer::handleRequest(const std::shared_ptr<Client>& client, const std::string& line) {
+    uint64_t id = 0;
+    try {
+        json j = json::parse(line);
+        if (j.contains("stats") && j["stats"].get<bool>()) {
+            std::string text = statistics().dump();
+            sendFrame(*client, SERVER_FRAME_STATS, 0, text.size(), text.data(), text.size());
+            return;
+        }
+
+        id = j.value("id", uint64_t(0));
+        const int count = j.at("count").get<int>();
+        const std::vector<double> distribution = j.value("distribution", config.getIntersectionDistribution());
+        const double volume_min = j.value("volume_min", config.getMinVolume());
+        const double volume_max = j.value("volume_max", config.getMaxVolume());
+        const int bins = j.value("bins", config.getNumBins());
+        // Without a seed every request draws a new one; the done frame reports it
+        const unsigned int seed = j.contains("seed") ? j["seed"].get<unsigned int>() : std::random_device{}();
+
+        if (count <= 0 || count > MAX_PAIRS_PER_REQUEST) {
+            throw std::invalid_argument("Count must be between 1 and " + std::to_string(MAX_PAIRS_PER_REQUEST));
+        }
+        Configuration::validateTargets(distribution, volume_min, volume_max, bins);
+        if (max_pairs_per_client > 0 && client->pairs_requested + count > max_pairs_per_client) {
+            throw std::runtime_error("Quota of " + std::to_string(max_pairs_per_client) + " pairs per client exceeded");
+        }
+        client->pairs_requested += count;
+
+        auto request = std::make_shared<Request>();
+        request->id = id;
+        request->seed = seed;
+        request->count = count;
+        request->received = std::chrono::steady_clock::now();
+        request->generator = std::make_unique<PairGenerator>(count, distribution, volume_min, volume_max, bins);
+        request->generator->configure(config);
+
+        // One entry per record, shuffled by the seed, so every batch mixes types and bins
+        std::vector<std::pair<int, int>> items;
+        items.reserve(count);
+        for (const auto& slice : request->generator->remainingSlices(count)) {
+            items.insert(items.end(), slice.count, std::make_pair(slice.type, slice.bin));
+        }
+        std::mt19937 shuffle_generator(seed);
+        std::shuffle(items.begin(), items.end(), shuffle_generator);
+
+        std::vector<Job> jobs;
+        for (size_t start = 0; start < items.size(); start += batch_size) {
+            size_t end = std::min(items.size(), start + batch_size);
+            jobs.push_back(Job{request, static_cast<int>(jobs.size()),
+                               std::vector<std::pair<int, int>>(items.begin() + start, items.begin() + end)});
+        }
+        request->pending_batches = static_cast<int>(jobs.size());
+
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            requests++;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            // A client is in the ready queue exactly while it has queued batches
+            if (client->jobs.empty()) ready.push_back(client);
+            for (auto& job : jobs) client->jobs.push_back(std::move(job));
+        }
+        queue_changed.notify_all();
+    } catch (const std::exception& e) {
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            rejected++;
+        }
+        std::string message = e.what();
+        sendFrame(*client, SERVER_FRAME_ERROR, id, message.size(), message.data(), message.size());
+    }
+}
+
+void GeneratorServer::workLoop() {
+    while (true) {
+        std::shared_ptr<Client> client;
+        Job job;
+        {
+            // Clients whose frames are not being read wait in the queue until they catch up
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            auto next = ready.end();
+            queue_changed.wait(lock, [&] {
+                next = std::find_if(ready.begin(), ready.end(), [this](const std::shared_ptr<Client>& candidate) {
+                    return candidate->outbox_bytes < outbox_limit;
+                });
+                return stopping || next != ready.end();
+            });
+            if (stopping) return;
+
+            client = *next;
+            ready.erase(next);
+            job = std::move(client->jobs.front());
+            client->jobs.pop_front();
+            if (!client->jobs.empty()) ready.push_back(client);
+        }
+        runJob(*client, job);
+    }
+}
+
+void GeneratorServer::runJob(Client& client, const Job& job) {
+    if (client.closed) return;
+    Request& request = *job.request;
+
+    try {
+        // Batches are seeded by their index, so the records do not depend on which worker runs them
+        TetrahedronFactory::setSeed(batchSeed(request.seed, job.index));
+
+        std::vector<ServerRecord> records(job.items.size());
+        // A bin no candidate can reach would otherwise hold this worker forever
+        uint64_t candidates = 0;
+        const auto stopped = [&] {
+            return ++candidates > MAX_CANDIDATES_PER_RECORD || request.failed || client.closed || stop_requested;
+        };
+        size_t i = 0;
+        for (; i < job.items.size(); ++i) {
+            candidates = 0;
+            PairRecord record;
+            if (!request.generator->generate(job.items[i].first, job.items[i].second, record, stopped)) break;
+            for (int v = 0; v < 4; ++v) {
+                for (int k = 0; k < 3; ++k) {
+                    records[i].coordinates[3 * v + k] = CGAL::to_double(record.T1.vertex(v)[k]);
+                    records[i].coordinates[12 + 3 * v + k] = CGAL::to_double(record.T2.vertex(v)[k]);
+                }
+            }
+            records[i].volume = record.volume;
+            records[i].intersects = record.intersects ? 1 : 0;
+            records[i].type = static_cast<uint32_t>(record.type);
+        }
+
+        // Once a request failed its remaining batches are dropped; only the first failure is reported
+        if (i < job.items.size() && candidates > MAX_CANDIDATES_PER_RECORD && !request.failed.exchange(true)) {
+            throw std::runtime_error("No type " + std::to_string(job.items[i].first) + " record after " +
+                                     std::to_string(MAX_CANDIDATES_PER_RECORD) + " candidates; the volume range or bins may be unreachable");
+        }
+        if (i == job.items.size()) {
+            const size_t payload = records.size() * sizeof(ServerRecord);
+            if (!sendFrame(client, SERVER_FRAME_BATCH, request.id, records.size(), records.data(), payload)) return;
+
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            if (!request.answered.exchange(true)) first_batch_latency.add(millisecondsSince(request.received));
+            pairs += records.size();
+            batches++;
+            bytes += sizeof(ServerFrameHeader) + payload;
+        }
+    } catch (const std::exception& e) {
+        std::string message = e.what();
+        sendFrame(client, SERVER_FRAME_ERROR, request.id, message.size(), message.data(), message.size());
+    }
+
+    if (--request.pending_batches == 0) {
+        ServerDone done{request.seed};
+        sendFrame(client, SERVER_FRAME_DONE, request.id, request.count, &done, sizeof(done));
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        request_duration.add(millisecondsSince(request.received));
+    }
+}
+
+bool GeneratorServer::sendFrame(Client& client, uint32_t kind, uint64_t request, uint32_t count, const void* payload, size_t bytes) {
+    ServerFrameHeader header;
+    std::memcpy(header.magic, "TPGS", 4);
+    header.kind = kind;
+    header.request = request;
+    header.count = count;
+    header.version = SERVER_PROTOCOL_VERSION;
+
+    if (client.closed) return false;
+    std::string frame(sizeof(header) + bytes, '\0');
+    std::memcpy(&frame[0], &header, sizeof(header));
+    if (bytes > 0) std::memcpy(&frame[sizeof(header)], payload, bytes);
+    {
+        std::lock_guard<std::mutex> lock(client.write_mutex);
+        client.outbox_bytes += frame.size();
+        client.outbox.push_back(std::move(frame));
+    }
+    // A failed signal only delays the frame until the client thread's next poll timeout
+    const uint64_t signal = 1;
+    ssize_t signalled = write(client.wake_fd, &signal, sizeof(signal));
+    (void)signalled;
+    return true;
+}
+
+bool GeneratorServer::sendQueued(Client& client) {
+    const bool was_full = client.outbox_bytes >= outbox_limit;
+    {
+        std::lock_guard<std::mutex> lock(client.write_mutex);
+        while (!client.outbox.empty()) {
+            const std::string& frame = client.outbox.front();
+            ssize_t sent = send(client.fd, frame.data() + client.sent, frame.size() - client.sent, MSG_NOSIGNAL);
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) break;
+            if (sent <= 0) {
+                client.closed = true;
+                return false;
+            }
+            client.sent += sent;
+            client.outbox_bytes -= sent;
+            if (client.sent == frame.size()) {
+                client.outbox.pop_front();
+                client.sent = 0;
+            }
+        }
+    }
+    if (was_full && client.outbox_bytes < outbox_limit) {
+        // The client takes batches again. Passing through the lock means a worker that has just
+        // found no client with room is already waiting when the notification comes.
+        { std::lock_guard<std::mutex> lock(queue_mutex); }
+        queue_changed.notify_all();
+    }
+    return true;
+}
+
+json GeneratorServer::statistics() {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    const double uptime = millisecondsSince(started) / 1000.0;
+
+    json result;
+    result["uptime_seconds"] = uptime;
+    result["workers"] = threads;
+    result["requests"] = requests;
+    result["rejected_requests"] = rejected;
+    result["pairs"] = pairs;
+    result["batches"] = batches;
+    result["bytes"] = bytes;
+    result["pairs_per_second"] = uptime > 0 ? pairs / uptime : 0.0;
+    result["first_batch_latency_ms"] = first_batch_latency.toJson();
+    result["request_duration_ms"] = request_duration.toJson();
+    return result;
+}
@@ -1,6 +1,57 @@
 #include "GeometryUtils.h"
+#include "GridGeometry.h"
+#include "TetrahedronBatchGenerator.h"
+
+// Random state is per thread so parallel workers draw independent, individually seeded streams
+static thread_local CGAL::Random randomGenerator;
+static int coordinateGridBits = 0; // 0 disables the fixed-point grid
+
+// Batched tetrahedron generation, disabled while batchSize is 0
+static thread_local std::unique_ptr<TetrahedronBatchGenerator> batchGenerator;
+static size_t batchSize = 0;
+static double batchMinAbsDeterminant = 0.0;
+
+static void resetBatchGenerator() {
+    if (batchSize == 0) {
+        batchGenerator.reset();
+        return;
+    }
+    batchGenerator = std::make_unique<TetrahedronBatchGenerator>(
+        randomGenerator.get_seed(), batchSize, batchMinAbsDeterminant, coordinateGridBits);
+}
+
+// Exact volume of the solid part of a Nef polyhedron, summed over its boundary facets without
+// regularizing or converting it. A facet between a marked and an unmarked volume bounds the solid;
+// its halffacet on the marked side is oriented consistently for all of them, so the signed fan
+// tetrahedra of its cycles add up to plus or minus six times the volume. Facets and edges with
+// solid or empty space on both sides contribute nothing.
+static ExactKernel::FT nefVolume(const Nef_polyhedron& N) {
+    ExactKernel::FT six_volume = 0;
+
+    Nef_polyhedron::Halffacet_const_iterator f;
+    for (f = N.halffacets_begin(); f != N.halffacets_end(); ++f) {
+        if (!f->incident_volume()->mark() || f->twin()->incident_volume()->mark()) continue;
+
+        Nef_polyhedron::Halffacet_cycle_const_iterator cycle;
+        for (cycle = f->facet_cycles_begin(); cycle != f->facet_cycles_end(); ++cycle) {
+            if (!cycle.is_shalfedge()) {
+                throw std::runtime_error("Nef volume: facet cycle without edges on a solid boundary");
+            }
+            Nef_polyhedron::SHalfedge_const_handle edge(cycle);
+            Nef_polyhedron::SHalfedge_around_facet_const_circulator current(edge), end(current);
+            const Vector origin = current->source()->center_vertex()->point() - CGAL::ORIGIN;
+            ++current;
+            Vector previous = current->source()->center_vertex()->point() - CGAL::ORIGIN;
+            for (++current; current != end; ++current) {
+                const Vector next = current->source()->center_vertex()->point() - CGAL::ORIGIN;
+                six_volume += CGAL::determinant(origin, previous, next);
+                previous = next;
+            }
+        }
+    }
 
-static CGAL::Random randomGenerator; // Static instance, initialized once
+    return CGAL::abs(six_volume) / 6;
+}
 
 std::vector<Point> GeometryUtils::getIntersectionShape(const Tetrahedron& T1, const Tetrahedron& T2) {
     std::vector<Point> resulting_shape;
@@ -28,6 +79,11 @@ std::vector<Point> GeometryUtils::getIntersectionShape(const Tetrahedron& T1, co
 }
 
 double GeometryUtils::getIntersectionVolume(const Tetrahedron& T1, const Tetrahedron& T2) {
+    if (coordinateGridBits > 0) {
+        return GridGeometry::getIntersectionVolume(
+            GridGeometry::snap(T1, coordinateGridBits), GridGeometry::snap(T2, coordinateGridBits), coordinateGridBits);
+    }
+
     double resulting_volume = 0;
     if(!checkIntersection(T1, T2)) return resulting_volume;
 
@@ -37,33 +93,61 @@ double GeometryUtils::getIntersectionVolume(const Tetrahedron& T1, const Tetrahe
     Nef_polyhedron intersection = nef1 * nef2;
 
     if(intersection.is_empty()) throw std::runtime_error("Intersection Shouldn't Be Empty Here");
-        
-    try {
-        Nef_polyhedron regularized = intersection.regularization();
-        if (regularized.is_simple()) {
-            intersection = regularized;
-        }
-    } catch (const std::exception& e) {
-        std::cerr << "Regularization Failed: " << e.what() << std::endl;
+
+    return CGAL::to_double(nefVolume(intersection));
+}
+
+double GeometryUtils::getVolume(const Tetrahedron& T) {
+    if (coordinateGridBits > 0) {
+        double six_volume = static_cast<double>(GridGeometry::signedSixVolume(GridGeometry::snap(T, coordinateGridBits)));
+        return std::ldexp(std::abs(six_volume), -3 * coordinateGridBits) / 6.0;
     }
+    return std::abs(CGAL::to_double(T.volume()));
+}
 
-    Polyhedron resulting_polyhedron;
-    try {
-        intersection.convert_to_polyhedron(resulting_polyhedron);
-    } catch (const std::exception& e) {
-        std::cerr << "Polyhedron Conversion Error: " << e.what() << std::endl;
+double GeometryUtils::approximateVolume(const std::array<std::array<double, 3>, 4>& v) {
+    double a[3], b[3], c[3];
+    for (int k = 0; k < 3; ++k) {
+        a[k] = v[1][k] - v[0][k];
+        b[k] = v[2][k] - v[0][k];
+        c[k] = v[3][k] - v[0][k];
     }
-    
-    if (resulting_polyhedron.is_empty()) return resulting_volume;
+    return std::abs(a[0] * (b[1] * c[2] - b[2] * c[1]) - a[1] * (b[0] * c[2] - b[2] * c[0]) + a[2] * (b[0] * c[1] - b[1] * c[0])) / 6.0;
+}
 
-    if (!CGAL::is_valid_polygon_mesh(resulting_polyhedron)) {
-        throw std::runtime_error("Something Went Wrong, Resulting Polyhedron Is Invalid Mesh");
+double GeometryUtils::approximateVolume(const Tetrahedron& T) {
+    std::array<std::array<double, 3>, 4> v;
+    for (int i = 0; i < 4; ++i) {
+        for (int k = 0; k < 3; ++k) v[i][k] = CGAL::to_double(T.vertex(i)[k]);
     }
+    return approximateVolume(v);
+}
 
-    auto volume = CGAL::Polygon_mesh_processing::volume(resulting_polyhedron);
-    resulting_volume = CGAL::to_double(volume);
+double GeometryUtils::getDistance(const Tetrahedron& T1, const Tetrahedron& T2) {
+    if (checkIntersection(T1, T2)) return 0.0;
+
+    // For disjoint convex polytopes the closest features are a vertex and a face, or two edges
+    constexpr int FACES[4][3] = {{0, 1, 2}, {0, 1, 3}, {0, 2, 3}, {1, 2, 3}};
+    constexpr int EDGES[6][2] = {{0, 1}, {0, 2}, {0, 3}, {1, 2}, {1, 3}, {2, 3}};
+
+    ExactKernel::FT squared_distance = CGAL::squared_distance(T1.vertex(0), T2.vertex(0));
+    for (const auto* T : {&T1, &T2}) {
+        const Tetrahedron& other = (T == &T1) ? T2 : T1;
+        for (const auto& face : FACES) {
+            Triangle triangle(other.vertex(face[0]), other.vertex(face[1]), other.vertex(face[2]));
+            for (int i = 0; i < 4; ++i) {
+                squared_distance = CGAL::min(squared_distance, CGAL::squared_distance(T->vertex(i), triangle));
+            }
+        }
+    }
+    for (const auto& e1 : EDGES) {
+        Segment s1(T1.vertex(e1[0]), T1.vertex(e1[1]));
+        for (const auto& e2 : EDGES) {
+            squared_distance = CGAL::min(squared_distance, CGAL::squared_distance(s1, Segment(T2.vertex(e2[0]), T2.vertex(e2[1]))));
+        }
+    }
 
-    return resulting_volume;
+    return std::sqrt(CGAL::to_double(squared_distance));
 }
 
 IntersectionType GeometryUtils::getIntersectionClassification(const Tetrahedron& T1, const Tetrahedron& T2) {
@@ -119,9 +203,38 @@ IntersectionType GeometryUtils::getIntersectionClassification(const Tetrahedron&
 }
 
 bool GeometryUtils::checkIntersection(const Tetrahedron& T1, const Tetrahedron& T2) {
+    if (coordinateGridBits > 0) {
+        return GridGeometry::checkIntersection(
+            GridGeometry::snap(T1, coordinateGridBits), GridGeometry::snap(T2, coordinateGridBits));
+    }
     return CGAL::do_intersect(T1, T2);
 }
 
+void GeometryUtils::setSeed(unsigned int seed) {
+    randomGenerator = CGAL::Random(seed);
+    if (batchSize > 0) resetBatchGenerator();
+}
+
+void GeometryUtils::swapRandomState(RandomState& state) {
+    std::swap(randomGenerator, state.random);
+    std::swap(batchGenerator, state.batch);
+}
+
+void GeometryUtils::setCoordinateGrid(int bits) {
+    coordinateGridBits = bits;
+    if (batchGenerator) resetBatchGenerator();
+}
+
+void GeometryUtils::setBatchGeneration(size_t size, double minAbsDeterminant) {
+    batchSize = size;
+    batchMinAbsDeterminant = minAbsDeterminant;
+    resetBatchGenerator();
+}
+
+int GeometryUtils::getCoordinateGrid() {
+    return coordinateGridBits;
+}
+
 Mesh GeometryUtils::tetrahedronToMesh(const Tetrahedron& T) {
     Mesh m;
 
@@ -137,6 +250,15 @@ Mesh GeometryUtils::tetrahedronToMesh(const Tetrahedron& T) {
 }
 
 Point GeometryUtils::generateRandomPoint() {
+    if (coordinateGridBits > 0) {
+        const int cells = 1 << coordinateGridBits;
+        return GridGeometry::toPoint({
+            randomGenerator.get_int(0, cells + 1),
+            randomGenerator.get_int(0, cells + 1),
+            randomGenerator.get_int(0, cells + 1)
+        }, coordinateGridBits);
+    }
+
     double x = randomGenerator.get_double(0.0, 1.0);
     double y = randomGenerator.get_double(0.0, 1.0);
     double z = randomGenerator.get_double(0.0, 1.0);
@@ -144,6 +266,10 @@ Point GeometryUtils::generateRandomPoint() {
 }
 
 Tetrahedron GeometryUtils::generateRandomTetrahedron(){
+    if (batchGenerator) {
+        return batchGenerator->next();
+    }
+
     Point vertexA, vertexB, vertexC, vertexD;
     Tetrahedron tetrahedron;
 
@@ -156,13 +282,15 @@ Tetrahedron GeometryUtils::generateRandomTetrahedron(){
 
         tetrahedron = Tetrahedron(vertexA, vertexB, vertexC, vertexD);
 
-    } while (tetrahedron.is_degenerate());
+    } while (coordinateGridBits > 0
+                 ? GridGeometry::isDegenerate(GridGeometry::snap(tetrahedron, coordinateGridBits))
+                 : tetrahedron.is_degenerate());
 
     return tetrahedron;
 }
 
 Point GeometryUtils::generateRandomPointOnTriangle(const Point& A, const Point& B, const Point& C) {
-    return *CGAL::Random_points_in_triangle_3<Point, CGAL::Creator_uniform_3<double, Point>>(A, B, C);
+    return *CGAL::Random_points_in_triangle_3<Point, CGAL::Creator_uniform_3<double, Point>>(A, B, C, randomGenerator);
 }
 
 Point GeometryUtils::generateRandomPointOutsideTetrahedron(const Tetrahedron tetrahedron) {
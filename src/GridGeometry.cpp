@@ -0,0 +1,282 @@
+#include "GridGeometry.h"
+#include <algorithm>
+
+typedef __int128 Wide;
+
+namespace {
+
+typedef std::array<double, 3> Vec3;
+typedef std::vector<Vec3> Face;
+
+// Tetrahedron faces as vertex indices, followed by the index of the opposite vertex
+constexpr int FACES[4][4] = {{0, 1, 2, 3}, {0, 1, 3, 2}, {0, 2, 3, 1}, {1, 2, 3, 0}};
+constexpr int EDGES[6][2] = {{0, 1}, {0, 2}, {0, 3}, {1, 2}, {1, 3}, {2, 3}};
+
+GridGeometry::GridPoint difference(const GridGeometry::GridPoint& a, const GridGeometry::GridPoint& b) {
+    return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+}
+
+GridGeometry::GridPoint cross(const GridGeometry::GridPoint& u, const GridGeometry::GridPoint& v) {
+    return {
+        u[1] * v[2] - u[2] * v[1],
+        u[2] * v[0] - u[0] * v[2],
+        u[0] * v[1] - u[1] * v[0]
+    };
+}
+
+Wide dot(const GridGeometry::GridPoint& u, const GridGeometry::GridPoint& v) {
+    return static_cast<Wide>(u[0]) * v[0] + static_cast<Wide>(u[1]) * v[1] + static_cast<Wide>(u[2]) * v[2];
+}
+
+double dot(const Vec3& u, const Vec3& v) {
+    return u[0] * v[0] + u[1] * v[1] + u[2] * v[2];
+}
+
+Vec3 subtract(const Vec3& a, const Vec3& b) {
+    return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+}
+
+Vec3 cross(const Vec3& u, const Vec3& v) {
+    return {u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0]};
+}
+
+Vec3 toVec3(const GridGeometry::GridPoint& p) {
+    return {static_cast<double>(p[0]), static_cast<double>(p[1]), static_cast<double>(p[2])};
+}
+
+// Orders coplanar points counter-clockwise around their centroid so they form a convex face
+Face orderAroundCentroid(Face points, const Vec3& normal) {
+    Vec3 centroid = {0, 0, 0};
+    for (const auto& p : points) {
+        for (int k = 0; k < 3; ++k) centroid[k] += p[k] / points.size();
+    }
+
+    Vec3 u = subtract(points[0], centroid);
+    for (const auto& p : points) {
+        Vec3 candidate = subtract(p, centroid);
+        if (dot(candidate, candidate) > dot(u, u)) u = candidate;
+    }
+    Vec3 v = cross(normal, u);
+
+    std::sort(points.begin(), points.end(), [&](const Vec3& a, const Vec3& b) {
+        Vec3 da = subtract(a, centroid);
+        Vec3 db = subtract(b, centroid);
+        return std::atan2(dot(da, v), dot(da, u)) < std::atan2(dot(db, v), dot(db, u));
+    });
+    return points;
+}
+
+// Keeps the part of a convex polyhedron satisfying normal * p <= offset
+std::vector<Face> clipPolyhedron(const std::vector<Face>& faces, const Vec3& normal, double offset) {
+    bool cut = false;
+    for (const auto& face : faces) {
+        for (const auto& p : face) {
+            if (dot(normal, p) > offset) cut = true;
+        }
+    }
+    if (!cut) return faces;
+
+    std::vector<Face> result;
+    Face cap;
+    for (const auto& face : faces) {
+        Face clipped;
+        for (size_t i = 0; i < face.size(); ++i) {
+            const Vec3& current = face[i];
+            const Vec3& next = face[(i + 1) % face.size()];
+            double current_distance = dot(normal, current) - offset;
+            double next_distance = dot(normal, next) - offset;
+
+            if (current_distance <= 0) clipped.push_back(current);
+            if (current_distance == 0) cap.push_back(current);
+
+            if ((current_distance < 0 && next_distance > 0) || (current_distance > 0 && next_distance < 0)) {
+                double t = current_distance / (current_distance - next_distance);
+                Vec3 crossing = {
+                    current[0] + t * (next[0] - current[0]),
+                    current[1] + t * (next[1] - current[1]),
+                    current[2] + t * (next[2] - current[2])
+                };
+                clipped.push_back(crossing);
+                cap.push_back(crossing);
+            }
+        }
+        if (clipped.size() >= 3) result.push_back(clipped);
+    }
+
+    if (cap.size() >= 3) result.push_back(orderAroundCentroid(cap, normal));
+    return result;
+}
+
+// Volume of a convex polyhedron as a fan of tetrahedra around an interior point
+double convexVolume(const std::vector<Face>& faces) {
+    Vec3 center = {0, 0, 0};
+    size_t count = 0;
+    for (const auto& face : faces) {
+        for (const auto& p : face) {
+            for (int k = 0; k < 3; ++k) center[k] += p[k];
+            ++count;
+        }
+    }
+    if (count == 0) return 0.0;
+    for (int k = 0; k < 3; ++k) center[k] /= count;
+
+    double volume = 0;
+    for (const auto& face : faces) {
+        Vec3 apex = subtract(face[0], center);
+        for (size_t i = 1; i + 1 < face.size(); ++i) {
+            Vec3 b = subtract(face[i], center);
+            Vec3 c = subtract(face[i + 1], center);
+            volume += std::abs(dot(apex, cross(b, c))) / 6.0;
+        }
+    }
+    return volume;
+}
+
+// Converts six times a signed volume in grid units to a volume in the unit cube
+double gridVolume(Wide signed_six_volume, int bits) {
+    Wide six_volume = signed_six_volume < 0 ? -signed_six_volume : signed_six_volume;
+    return std::ldexp(static_cast<double>(six_volume), -3 * bits) / 6.0;
+}
+
+} // namespace
+
+GridGeometry::GridPoint GridGeometry::snap(const Point& p, int bits) {
+    const double scale = std::ldexp(1.0, bits);
+    return {
+        std::llround(CGAL::to_double(p.x()) * scale),
+        std::llround(CGAL::to_double(p.y()) * scale),
+        std::llround(CGAL::to_double(p.z()) * scale)
+    };
+}
+
+GridGeometry::GridTetrahedron GridGeometry::snap(const Tetrahedron& T, int bits) {
+    return {snap(T.vertex(0), bits), snap(T.vertex(1), bits), snap(T.vertex(2), bits), snap(T.vertex(3), bits)};
+}
+
+Point GridGeometry::toPoint(const GridPoint& p, int bits) {
+    return Point(std::ldexp(static_cast<double>(p[0]), -bits),
+                 std::ldexp(static_cast<double>(p[1]), -bits),
+                 std::ldexp(static_cast<double>(p[2]), -bits));
+}
+
+Tetrahedron GridGeometry::toTetrahedron(const GridTetrahedron& T, int bits) {
+    return Tetrahedron(toPoint(T[0], bits), toPoint(T[1], bits), toPoint(T[2], bits), toPoint(T[3], bits));
+}
+
+int GridGeometry::orientation(const GridPoint& a, const GridPoint& b, const GridPoint& c, const GridPoint& d) {
+    Wide det = dot(cross(difference(b, a), difference(c, a)), difference(d, a));
+    return (det > 0) - (det < 0);
+}
+
+Wide GridGeometry::signedSixVolume(const GridTetrahedron& T) {
+    return dot(cross(difference(T[1], T[0]), difference(T[2], T[0])), difference(T[3], T[0]));
+}
+
+bool GridGeometry::isDegenerate(const GridTetrahedron& T) {
+    return signedSixVolume(T) == 0;
+}
+
+bool GridGeometry::contains(const GridTetrahedron& outer, const GridTetrahedron& inner) {
+    for (const auto& face : FACES) {
+        int inside = orientation(outer[face[0]], outer[face[1]], outer[face[2]], outer[face[3]]);
+        for (const auto& p : inner) {
+            int side = orientation(outer[face[0]], outer[face[1]], outer[face[2]], p);
+            if (side != 0 && side != inside) return false;
+        }
+    }
+    return true;
+}
+
+bool GridGeometry::isSeparated(const GridTetrahedron& T1, const GridTetrahedron& T2, bool strict) {
+    // Separating axis test: for convex polytopes the face normals and the pairwise
+    // edge cross products are the only candidate axes
+    std::vector<GridPoint> axes;
+    axes.reserve(4 + 4 + 36);
+    for (const auto* T : {&T1, &T2}) {
+        for (const auto& face : FACES) {
+            axes.push_back(cross(difference((*T)[face[1]], (*T)[face[0]]), difference((*T)[face[2]], (*T)[face[0]])));
+        }
+    }
+    for (const auto& e1 : EDGES) {
+        for (const auto& e2 : EDGES) {
+            axes.push_back(cross(difference(T1[e1[1]], T1[e1[0]]), difference(T2[e2[1]], T2[e2[0]])));
+        }
+    }
+
+    for (const auto& axis : axes) {
+        if (axis[0] == 0 && axis[1] == 0 && axis[2] == 0) continue;
+
+        Wide min1 = dot(axis, T1[0]), max1 = min1;
+        Wide min2 = dot(axis, T2[0]), max2 = min2;
+        for (int i = 1; i < 4; ++i) {
+            Wide p1 = dot(axis, T1[i]);
+            Wide p2 = dot(axis, T2[i]);
+            min1 = std::min(min1, p1); max1 = std::max(max1, p1);
+            min2 = std::min(min2, p2); max2 = std::max(max2, p2);
+        }
+
+        if (strict ? (max1 < min2 || max2 < min1) : (max1 <= min2 || max2 <= min1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool GridGeometry::checkIntersection(const GridTetrahedron& T1, const GridTetrahedron& T2) {
+    return !isSeparated(T1, T2, true);
+}
+
+bool GridGeometry::checkInteriorIntersection(const GridTetrahedron& T1, const GridTetrahedron& T2) {
+    return !isSeparated(T1, T2, false);
+}
+
+double GridGeometry::getIntersectionVolume(const GridTetrahedron& T1, const GridTetrahedron& T2, int bits) {
+    if (!checkInteriorIntersection(T1, T2)) return 0.0;
+
+    // Containment is decided exactly, and then the volume is exact as well
+    if (contains(T1, T2)) return gridVolume(signedSixVolume(T2), bits);
+    if (contains(T2, T1)) return gridVolume(signedSixVolume(T1), bits);
+
+    // General overlap: clip T2 by the half-spaces of T1 in grid units, where the input planes are exact
+    std::vector<Face> polyhedron;
+    for (const auto& face : FACES) {
+        polyhedron.push_back({toVec3(T2[face[0]]), toVec3(T2[face[1]]), toVec3(T2[face[2]])});
+    }
+
+    for (const auto& face : FACES) {
+        GridPoint normal = cross(difference(T1[face[1]], T1[face[0]]), difference(T1[face[2]], T1[face[0]]));
+        if (dot(normal, difference(T1[face[3]], T1[face[0]])) > 0) {
+            normal = {-normal[0], -normal[1], -normal[2]};
+        }
+        polyhedron = clipPolyhedron(polyhedron, toVec3(normal), static_cast<double>(dot(normal, T1[face[0]])));
+        if (polyhedron.empty()) return 0.0;
+    }
+
+    return std::ldexp(convexVolume(polyhedron), -3 * bits);
+}
+
+double GridGeometry::estimateIntersectionVolume(const Tetrahedron& T1, const Tetrahedron& T2) {
+    Vec3 a[4], b[4];
+    for (int i = 0; i < 4; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            a[i][k] = CGAL::to_double(T1.vertex(i)[k]);
+            b[i][k] = CGAL::to_double(T2.vertex(i)[k]);
+        }
+    }
+
+    std::vector<Face> polyhedron;
+    for (const auto& face : FACES) {
+        polyhedron.push_back({b[face[0]], b[face[1]], b[face[2]]});
+    }
+
+    for (const auto& face : FACES) {
+        Vec3 normal = cross(subtract(a[face[1]], a[face[0]]), subtract(a[face[2]], a[face[0]]));
+        if (dot(normal, subtract(a[face[3]], a[face[0]])) > 0) {
+            normal = {-normal[0], -normal[1], -normal[2]};
+        }
+        polyhedron = clipPolyhedron(polyhedron, normal, dot(normal, a[face[0]]));
+        if (polyhedron.empty()) return 0.0;
+    }
+
+    return convexVolume(polyhedron);
+}
@@ -10,7 +10,16 @@ JSONWriter::JSONWriter(const std::string& filename){
 }
 
 JSONWriter::~JSONWriter() {
-    outFile << data.dump(4); // Pretty print with 4 spaces indent
+    try {
+        close();
+    } catch (const std::exception& e) {
+        std::cerr << "Error closing JSON output: " << e.what() << std::endl;
+    }
+}
+
+void JSONWriter::close() {
+    if (!outFile.is_open()) return;
+    outFile << (idCounter == 1 ? "[]" : "\n]");
     outFile.close();
 }
 
@@ -21,7 +30,14 @@ void JSONWriter::writeEntry(const Tetrahedron& T1, const Tetrahedron& T2, double
     entry["tetrahedron_2"] = tetrahedronToJson(T2);
     entry["intersection_status"] = intersectionStatus ? 1 : 0;
 
-    data.push_back(entry);
+    // Same layout as dumping the whole array with 4 spaces indent: one level deeper per entry
+    std::string text = entry.dump(4);
+    size_t position = 0;
+    while ((position = text.find('\n', position)) != std::string::npos) {
+        text.insert(position + 1, "    ");
+        position += 5;
+    }
+    outFile << (idCounter == 2 ? "[\n    " : ",\n    ") << text;
 }
 
 json JSONWriter::tetrahedronToJson(const Tetrahedron& tetrahedron) {
@@ -0,0 +1,263 @@
+#include "MappedDataset.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Column roles besides the 24 coordinates
+static constexpr int ROLE_VOLUME = 24;
+static constexpr int ROLE_INTERSECTS = 25;
+static constexpr int ROLE_TYPE = 26;
+static constexpr int ROLE_GAP = 27;
+static constexpr int ROLE_IGNORE = 28;
+
+static constexpr size_t MIN_CHUNK_BYTES = 1 << 20;
+static constexpr int CHUNKS_PER_THREAD = 4; // spare chunks even out rows of different cost
+
+struct MappedDataset::Chunk {
+    size_t begin;
+    size_t end;
+    size_t first_line;  // line number of the first row, for error messages
+    size_t capacity;    // lines in the chunk, an upper bound on its rows
+    size_t offset = 0;  // first output row of the chunk
+    size_t kept = 0;
+};
+
+// Runs task(0) ... task(count - 1) on up to threads threads and rethrows the first failure
+static void parallelFor(size_t count, int threads, const std::function<void(size_t)>& task) {
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    auto work = [&] {
+        try {
+            for (size_t i = next++; i < count && !failed; i = next++) task(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) error = std::current_exception();
+            failed = true;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < std::min<size_t>(threads, count); ++t) pool.emplace_back(work);
+    work();
+    for (auto& thread : pool) thread.join();
+    if (error) std::rethrow_exception(error);
+}
+
+MappedDataset::MappedDataset(const std::string& filename) : filename(filename) {
+    int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Unable to open file: " + filename);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        throw std::runtime_error("Missing header in dataset: " + filename);
+    }
+    size = static_cast<size_t>(info.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Unable to map file: " + filename);
+    }
+    data = static_cast<const char*>(mapping);
+    madvise(mapping, size, MADV_SEQUENTIAL);
+
+    if (size >= 2 && static_cast<unsigned char>(data[0]) == 0x1f && static_cast<unsigned char>(data[1]) == 0x8b) {
+        munmap(mapping, size);
+        throw std::runtime_error("Compressed datasets cannot be mapped, decompress first: " + filename);
+    }
+
+    const char* newline = static_cast<const char*>(std::memchr(data, '\n', size));
+    body = newline ? static_cast<size_t>(newline - data) + 1 : size;
+    std::string header(data, newline ? newline - data : size);
+    if (!header.empty() && header.back() == '\r') header.pop_back();
+    size_t start = 0;
+    while (true) {
+        size_t comma = header.find(',', start);
+        headers.push_back(header.substr(start, comma - start));
+        if (comma == std::string::npos) break;
+        start = comma + 1;
+    }
+
+    // Same names as CSVWriter::setHeaders
+    std::vector<std::string> coordinates;
+    for (int i = 1; i <= 2; ++i) {
+        for (int v = 1; v <= 4; ++v) {
+            for (const char* axis : {"x", "y", "z"}) {
+                coordinates.push_back("T" + std::to_string(i) + "_v" + std::to_string(v) + "_" + axis);
+            }
+        }
+    }
+    std::vector<bool> found(ROLE_IGNORE, false);
+    for (size_t c = 0; c < headers.size(); ++c) {
+        int role = ROLE_IGNORE;
+        auto it = std::find(coordinates.begin(), coordinates.end(), headers[c]);
+        if (it != coordinates.end()) role = static_cast<int>(it - coordinates.begin());
+        else if (headers[c] == "IntersectionVolume") role = ROLE_VOLUME;
+        else if (headers[c] == "HasIntersection") role = ROLE_INTERSECTS;
+        else if (headers[c] == "IntersectionType") role = ROLE_TYPE;
+        else if (headers[c] == "Gap") role = ROLE_GAP;
+
+        if (role != ROLE_IGNORE) {
+            if (found[role]) role = ROLE_IGNORE; // a repeated column keeps its first occurrence
+            else found[role] = true;
+        }
+        if (role == ROLE_TYPE) type_column = static_cast<int>(c);
+        if (role == ROLE_GAP) gap_column = static_cast<int>(c);
+        roles.push_back(role);
+    }
+    if (!std::all_of(found.begin(), found.begin() + ROLE_TYPE, [](bool f) { return f; })) {
+        munmap(mapping, size);
+        throw std::runtime_error("Not a tetrahedron pair dataset: " + filename);
+    }
+}
+
+MappedDataset::~MappedDataset() {
+    munmap(const_cast<char*>(data), size);
+}
+
+DatasetColumns MappedDataset::read(const DatasetFilter& filter, int threads) const {
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int type : filter.types) {
+        if (type < 1 || type > 5) {
+            throw std::invalid_argument("Filter types must be between 1 and 5");
+        }
+        if (type_column < 0 && type >= 2 && type <= 4) {
+            throw std::invalid_argument("Filtering contact types needs the IntersectionType column: " + filename);
+        }
+    }
+
+    // Chunks end after a newline, so every row lies in exactly one chunk
+    const size_t length = size - body;
+    const size_t count = std::max<size_t>(1, std::min<size_t>(static_cast<size_t>(threads) * CHUNKS_PER_THREAD, length / MIN_CHUNK_BYTES));
+    std::vector<Chunk> chunks;
+    size_t begin = body;
+    for (size_t k = 1; k <= count; ++k) {
+        size_t end = size;
+        if (k < count) {
+            end = std::max(begin, body + length / count * k);
+            const char* newline = static_cast<const char*>(std::memchr(data + end, '\n', size - end));
+            end = newline ? static_cast<size_t>(newline - data) + 1 : size;
+        }
+        chunks.push_back(Chunk{begin, end, 0, 0});
+        begin = end;
+    }
+
+    parallelFor(chunks.size(), threads, [&](size_t k) {
+        Chunk& chunk = chunks[k];
+        chunk.capacity = std::count(data + chunk.begin, data + chunk.end, '\n');
+        if (chunk.end == size && chunk.end > chunk.begin && data[size - 1] != '\n') chunk.capacity++;
+    });
+
+    size_t capacity = 0;
+    for (Chunk& chunk : chunks) {
+        chunk.offset = capacity;
+        chunk.first_line = capacity + 2;
+        capacity += chunk.capacity;
+    }
+
+    DatasetColumns columns;
+    columns.coordinates.resize(capacity * 24);
+    columns.volumes.resize(capacity);
+    columns.intersects.resize(capacity);
+    columns.types.resize(capacity);
+    if (hasGaps()) columns.gaps.resize(capacity);
+
+    parallelFor(chunks.size(), threads, [&](size_t k) { parseChunk(chunks[k], filter, columns); });
+
+    // Rows of a chunk are contiguous from its offset; close the gaps left by filtered and blank lines
+    size_t rows = 0;
+    for (const Chunk& chunk : chunks) {
+        if (chunk.offset != rows && chunk.kept > 0) {
+            std::memmove(&columns.coordinates[rows * 24], &columns.coordinates[chunk.offset * 24], chunk.kept * 24 * sizeof(float));
+            std::memmove(&columns.volumes[rows], &columns.volumes[chunk.offset], chunk.kept * sizeof(float));
+            std::memmove(&columns.intersects[rows], &columns.intersects[chunk.offset], chunk.kept);
+            std::memmove(&columns.types[rows], &columns.types[chunk.offset], chunk.kept);
+            if (hasGaps()) std::memmove(&columns.gaps[rows], &columns.gaps[chunk.offset], chunk.kept * sizeof(float));
+        }
+        rows += chunk.kept;
+    }
+    columns.rows = rows;
+    columns.coordinates.resize(rows * 24);
+    columns.volumes.resize(rows);
+    columns.intersects.resize(rows);
+    columns.types.resize(rows);
+    if (hasGaps()) columns.gaps.resize(rows);
+    return columns;
+}
+
+void MappedDataset::parseChunk(Chunk& chunk, const DatasetFilter& filter, DatasetColumns& columns) const {
+    uint32_t accepted = 0;
+    for (int type : filter.types) accepted |= 1u << type;
+
+    const char* cursor = data + chunk.begin;
+    const char* const end = data + chunk.end;
+    size_t line = chunk.first_line;
+    size_t row = chunk.offset;
+
+    for (; cursor < end; ++line) {
+        const char* newline = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+        const char* line_end = newline ? newline : end;
+        const char* next = newline ? newline + 1 : end;
+        if (line_end > cursor && line_end[-1] == '\r') line_end--;
+        if (line_end == cursor) {
+            cursor = next;
+            continue;
+        }
+
+        auto fail = [&](const char* reason) {
+            throw std::runtime_error(std::string(reason) + " on line " + std::to_string(line) + " of " + filename);
+        };
+
+        float* coordinates = &columns.coordinates[row * 24];
+        double volume = 0.0;
+        double gap = 0.0;
+        int intersects = 0;
+        int type = 0;
+        for (size_t c = 0; c < roles.size(); ++c) {
+            const char* field_end = static_cast<const char*>(std::memchr(cursor, ',', line_end - cursor));
+            if (!field_end) field_end = line_end;
+            if ((c + 1 < roles.size()) != (field_end < line_end)) {
+                fail(c + 1 < roles.size() ? "Missing columns" : "Extra columns");
+            }
+
+            std::from_chars_result result{cursor, std::errc()};
+            const int role = roles[c];
+            if (role < 24) result = std::from_chars(cursor, field_end, coordinates[role]);
+            else if (role == ROLE_VOLUME) result = std::from_chars(cursor, field_end, volume);
+            else if (role == ROLE_INTERSECTS) result = std::from_chars(cursor, field_end, intersects);
+            else if (role == ROLE_TYPE) result = std::from_chars(cursor, field_end, type);
+            else if (role == ROLE_GAP) result = std::from_chars(cursor, field_end, gap);
+            else result.ptr = field_end;
+            if (result.ec != std::errc() || result.ptr != field_end) fail("Malformed value");
+
+            cursor = field_end + 1;
+        }
+        cursor = next;
+
+        // Without the column, only the types that follow from status and volume are known
+        if (type_column < 0) type = intersects == 0 ? 1 : volume > 0 ? 5 : 0;
+        if (accepted != 0 && (type < 0 || type > 31 || !(accepted & (1u << type)))) continue;
+        if (volume < filter.volume_min || volume > filter.volume_max) continue;
+
+        columns.volumes[row] = static_cast<float>(volume);
+        columns.intersects[row] = intersects != 0;
+        columns.types[row] = static_cast<int8_t>(type);
+        if (hasGaps()) columns.gaps[row] = static_cast<float>(gap);
+        row++;
+    }
+    chunk.kept = row - chunk.offset;
+}
@@ -0,0 +1,160 @@
+#include "MemoryMonitor.h"
+#include "Metrics.h"
+#include <cstdio>
+#include <chrono>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+static constexpr size_t MAX_SAMPLES = 512; // the interval doubles whenever this many are taken
+static constexpr double SOFT_LIMIT = 0.9;  // share of the ceiling at which flushing starts
+
+bool MemoryMonitor::enabled = false;
+bool MemoryMonitor::attributeStages = false;
+uint64_t MemoryMonitor::sampleInterval = 1000;
+uint64_t MemoryMonitor::ceiling = 0;
+uint64_t MemoryMonitor::softLimit = 0;
+uint64_t MemoryMonitor::nextSample = 0;
+uint64_t MemoryMonitor::quietUntil = 0;
+std::mutex MemoryMonitor::mutex;
+std::map<std::string, MemoryMonitor::StageUsage> MemoryMonitor::stages;
+json MemoryMonitor::samples = json::array();
+
+static std::chrono::steady_clock::time_point started;
+
+static double megabytes(double bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+MemoryMonitor::Stage::Stage(const char* name)
+    : name(name), heap(enabled && attributeStages ? static_cast<int64_t>(heapBytes()) : -1) {}
+
+MemoryMonitor::Stage::~Stage() {
+    if (heap < 0) return;
+    const int64_t growth = static_cast<int64_t>(heapBytes()) - heap;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    StageUsage& usage = stages[name];
+    usage.calls++;
+    usage.retained += growth;
+    usage.maxGrowth = std::max(usage.maxGrowth, growth);
+}
+
+void MemoryMonitor::enable(uint64_t interval, uint64_t ceilingBytes, bool stages) {
+    if (interval == 0) {
+        throw std::invalid_argument("Memory sample interval must be greater than 0");
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    enabled = true;
+    attributeStages = stages;
+    sampleInterval = interval;
+    ceiling = ceilingBytes;
+    softLimit = static_cast<uint64_t>(ceilingBytes * SOFT_LIMIT);
+    nextSample = 0;
+    quietUntil = 0;
+    started = std::chrono::steady_clock::now();
+}
+
+uint64_t MemoryMonitor::residentBytes() {
+    // statm is regenerated on every read from offset 0, so the file stays open
+    static const int fd = open("/proc/self/statm", O_RDONLY | O_CLOEXEC);
+    static const long page = sysconf(_SC_PAGESIZE);
+    if (fd < 0) return 0;
+
+    char text[128];
+    ssize_t length = pread(fd, text, sizeof(text) - 1, 0);
+    if (length <= 0) return 0;
+    text[length] = '\0';
+
+    unsigned long long size = 0, resident = 0;
+    if (std::sscanf(text, "%llu %llu", &size, &resident) != 2) return 0;
+    return resident * page;
+}
+
+uint64_t MemoryMonitor::heapBytes() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+static uint64_t peakResidentBytes() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) return std::stoull(line.substr(6)) * 1024;
+    }
+    return 0;
+}
+
+bool MemoryMonitor::record(uint64_t records) {
+    if (!enabled) return false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (records >= nextSample) {
+        json sample;
+        sample["records"] = records;
+        sample["seconds"] = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        sample["rss_mb"] = megabytes(residentBytes());
+        sample["heap_mb"] = megabytes(heapBytes());
+        samples.push_back(sample);
+        nextSample = records + sampleInterval;
+
+        // Long runs keep a bounded number of samples spread over the whole run
+        if (samples.size() >= MAX_SAMPLES) {
+            json kept = json::array();
+            for (size_t i = 0; i < samples.size(); i += 2) kept.push_back(samples[i]);
+            samples = kept;
+            sampleInterval *= 2;
+        }
+    }
+
+    if (ceiling == 0 || records < quietUntil || residentBytes() < softLimit) return false;
+    // One flush per interval at most, or a flush that frees too little would run for every record
+    quietUntil = records + sampleInterval;
+    return true;
+}
+
+void MemoryMonitor::relieve() {
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+    const uint64_t resident = residentBytes();
+    if (resident >= ceiling) Metrics::increment("memory.over_ceiling");
+    Metrics::increment("memory.flushes");
+}
+
+void MemoryMonitor::throttle() {
+    if (!enabled || ceiling == 0) return;
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto limit = start + std::chrono::seconds(1);
+    while (residentBytes() >= ceiling && std::chrono::steady_clock::now() < limit) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    const auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    if (waited > 0) Metrics::increment("memory.throttled_ms", waited);
+}
+
+json MemoryMonitor::toJson() {
+    std::lock_guard<std::mutex> lock(mutex);
+    json result;
+    result["ceiling_mb"] = megabytes(ceiling);
+    result["sample_interval"] = sampleInterval;
+    result["rss_mb"] = megabytes(residentBytes());
+    result["peak_rss_mb"] = megabytes(peakResidentBytes());
+    result["heap_mb"] = megabytes(heapBytes());
+    result["stage_attribution"] = attributeStages;
+    for (const auto& [name, usage] : stages) {
+        result["stages"][name]["calls"] = usage.calls;
+        result["stages"][name]["retained_mb"] = megabytes(usage.retained);
+        result["stages"][name]["max_growth_mb"] = megabytes(usage.maxGrowth);
+    }
+    result["samples"] = samples;
+    return result;
+}
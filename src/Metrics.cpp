@@ -0,0 +1,38 @@
+#include "Metrics.h"
+
+std::mutex Metrics::mutex;
+std::map<std::string, uint64_t> Metrics::counters;
+json Metrics::values = json::object();
+
+void Metrics::increment(const std::string& name, uint64_t amount) {
+    std::lock_guard<std::mutex> lock(mutex);
+    counters[name] += amount;
+}
+
+void Metrics::set(const std::string& name, const json& value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    values[name] = value;
+}
+
+uint64_t Metrics::count(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = counters.find(name);
+    return it == counters.end() ? 0 : it->second;
+}
+
+json Metrics::toJson() {
+    std::lock_guard<std::mutex> lock(mutex);
+    json result = values;
+    for (const auto& [name, count] : counters) {
+        result[name] = count;
+    }
+    return result;
+}
+
+void Metrics::write(const std::string& filename) {
+    std::ofstream outFile(filename);
+    if (!outFile) {
+        throw std::runtime_error("Unable to open file: " + filename);
+    }
+    outFile << toJson().dump(4);
+}
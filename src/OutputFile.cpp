@@ -0,0 +1,575 @@
+#include "OutputFile.h"
+#include "Checksum.h"
+#include "Metrics.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#define TPG_HAVE_IO_URING 1
+#endif
+
+static int compressionLevel = 0; // 0 writes plain files
+static size_t asyncBlockSize = 0;
+static int asyncBlocks = 0;      // 0 writes plain files through std::filebuf
+static bool asyncDirect = false;
+static bool checksums = false;
+
+GzipStreamBuffer::GzipStreamBuffer(int level) : level(level) {}
+
+GzipStreamBuffer::~GzipStreamBuffer() {
+    try {
+        finish();
+    } catch (const std::exception& e) {
+        std::cerr << "Compressed output failed: " << e.what() << std::endl;
+    }
+}
+
+bool GzipStreamBuffer::open(const std::string& filename, bool append) {
+    // Appending starts a new gzip member, and concatenated members are still one valid gzip file
+    file = std::fopen(filename.c_str(), append ? "ab" : "wb");
+    if (!file) return false;
+
+    stream = z_stream();
+    if (deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        std::fclose(file);
+        file = nullptr;
+        return false;
+    }
+
+    block.resize(BLOCK_SIZE);
+    setp(block.data(), block.data() + block.size());
+    worker = std::thread(&GzipStreamBuffer::compressLoop, this);
+    return true;
+}
+
+void GzipStreamBuffer::finish() {
+    if (!file || finished) return;
+    finished = true;
+
+    handOff();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finishing = true;
+    }
+    changed.notify_all();
+    worker.join();
+
+    deflateEnd(&stream);
+    if (std::fclose(file) != 0 && error.empty()) error = "Unable to close compressed file";
+    file = nullptr;
+
+    if (!error.empty()) throw std::runtime_error(error);
+}
+
+GzipStreamBuffer::int_type GzipStreamBuffer::overflow(int_type ch) {
+    handOff();
+    if (hasError()) return traits_type::eof();
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+int GzipStreamBuffer::sync() {
+    handOff();
+    return hasError() ? -1 : 0;
+}
+
+GzipStreamBuffer::pos_type GzipStreamBuffer::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) {
+    // Only reports the position, counted in uncompressed bytes
+    if (off != 0 || dir != std::ios_base::cur || !(which & std::ios_base::out)) return pos_type(off_type(-1));
+    return pos_type(static_cast<off_type>(handedOff + (pptr() - pbase())));
+}
+
+bool GzipStreamBuffer::hasError() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !error.empty();
+}
+
+void GzipStreamBuffer::handOff() {
+    const size_t size = pptr() - pbase();
+    if (size == 0 || finishing) return;
+    block.resize(size);
+    handedOff += size;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&] { return queue.size() < MAX_QUEUED_BLOCKS || !error.empty(); });
+    queue.push_back(std::move(block));
+    if (spare.empty()) {
+        block = std::vector<char>();
+    } else {
+        block = std::move(spare.back());
+        spare.pop_back();
+    }
+    lock.unlock();
+    changed.notify_all();
+
+    block.resize(BLOCK_SIZE);
+    setp(block.data(), block.data() + block.size());
+}
+
+void GzipStreamBuffer::compressLoop() {
+    std::vector<unsigned char> out(BLOCK_SIZE);
+    while (true) {
+        std::vector<char> input;
+        bool last = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] { return !queue.empty() || finishing; });
+            if (queue.empty()) {
+                last = true;
+            } else {
+                input = std::move(queue.front());
+                queue.pop_front();
+            }
+        }
+        changed.notify_all();
+
+        stream.next_in = reinterpret_cast<Bytef*>(input.data());
+        stream.avail_in = static_cast<uInt>(input.size());
+        do {
+            stream.next_out = out.data();
+            stream.avail_out = static_cast<uInt>(out.size());
+            if (deflate(&stream, last ? Z_FINISH : Z_NO_FLUSH) == Z_STREAM_ERROR) {
+                std::lock_guard<std::mutex> lock(mutex);
+                error = "Compression failed";
+            }
+            size_t produced = out.size() - stream.avail_out;
+            if (error.empty() && std::fwrite(out.data(), 1, produced, file) != produced) {
+                std::lock_guard<std::mutex> lock(mutex);
+                error = "Unable to write compressed file";
+            }
+        } while (stream.avail_out == 0 && error.empty());
+
+        if (!error.empty()) {
+            // Keep draining so a blocked writer wakes up and sees the error
+            changed.notify_all();
+            std::unique_lock<std::mutex> lock(mutex);
+            queue.clear();
+            if (finishing) return;
+            continue;
+        }
+        if (last) return;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        spare.push_back(std::move(input));
+    }
+}
+
+#ifdef TPG_HAVE_IO_URING
+// Submission and completion queues of one io_uring instance, mapped without liburing. Only the
+// thread that writes to the stream touches them, so the ring needs no lock of its own.
+struct AsyncStreamBuffer::Ring {
+    int fd = -1;
+    void* sqRing = MAP_FAILED;
+    void* cqRing = MAP_FAILED;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqRingSize = 0, cqRingSize = 0, sqesSize = 0;
+    unsigned *sqTail, *sqMask, *sqArray;
+    unsigned *cqHead, *cqTail, *cqMask;
+    io_uring_cqe* cqes;
+    std::vector<iovec> vectors; // one per block; writev is the oldest write operation io_uring has
+
+    bool setup(unsigned entries) {
+        io_uring_params params{};
+        fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) return false;
+
+        sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+        if (sqRing == MAP_FAILED || cqRing == MAP_FAILED || sqes == MAP_FAILED) return false;
+
+        char* sq = static_cast<char*>(sqRing);
+        char* cq = static_cast<char*>(cqRing);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        vectors.resize(entries);
+        return true;
+    }
+
+    ~Ring() {
+        if (sqes != MAP_FAILED) munmap(sqes, sqesSize);
+        if (cqRing != MAP_FAILED) munmap(cqRing, cqRingSize);
+        if (sqRing != MAP_FAILED) munmap(sqRing, sqRingSize);
+        if (fd >= 0) close(fd);
+    }
+
+    bool enter(unsigned submit, unsigned wait) {
+        while (syscall(__NR_io_uring_enter, fd, submit, wait, wait > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0) < 0) {
+            if (errno != EINTR) return false;
+        }
+        return true;
+    }
+
+    // At most one write per block is in flight, so the queue never holds more than it has room for
+    bool push(int file, int index, const char* data, size_t size, uint64_t offset) {
+        vectors[index] = iovec{const_cast<char*>(data), size};
+        const unsigned tail = *sqTail;
+        const unsigned slot = tail & *sqMask;
+        io_uring_sqe& sqe = sqes[slot];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_WRITEV;
+        sqe.fd = file;
+        sqe.addr = reinterpret_cast<uint64_t>(&vectors[index]);
+        sqe.len = 1;
+        sqe.off = offset;
+        sqe.user_data = static_cast<uint64_t>(index);
+        sqArray[slot] = slot;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        return enter(1, 0);
+    }
+
+    // Hands every available completion to done, after waiting for one if wait is set
+    template <typename Done>
+    bool reap(bool wait, Done done) {
+        unsigned head = *cqHead;
+        if (wait && head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE) && !enter(0, 1)) return false;
+        for (; head != __atomic_load_n(cqTail, __ATOMIC_ACQUIRE); ++head) {
+            const io_uring_cqe& cqe = cqes[head & *cqMask];
+            const int index = static_cast<int>(cqe.user_data);
+            const int result = cqe.res;
+            __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+            done(index, result);
+        }
+        return true;
+    }
+};
+#else
+// Never set up without the io_uring header; only keeps the calls below well-formed
+struct AsyncStreamBuffer::Ring {
+    bool push(int, int, const char*, size_t, uint64_t) { return false; }
+    template <typename Done>
+    bool reap(bool, Done) { return false; }
+};
+#endif
+
+AsyncStreamBuffer::AsyncStreamBuffer(size_t blockSize, int count, bool direct)
+    : blockSize((blockSize + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT), direct(direct), blocks(std::max(count, 2)) {}
+
+AsyncStreamBuffer::~AsyncStreamBuffer() {
+    try {
+        finish();
+    } catch (const std::exception& e) {
+        std::cerr << "Asynchronous output failed: " << e.what() << std::endl;
+    }
+}
+
+bool AsyncStreamBuffer::open(const std::string& filename, bool append) {
+    const int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (append ? 0 : O_TRUNC);
+    fd = direct ? ::open(filename.c_str(), flags | O_DIRECT, 0644) : -1;
+    directActive = fd >= 0;
+    if (fd < 0) fd = ::open(filename.c_str(), flags, 0644); // tmpfs and others refuse O_DIRECT
+    if (fd < 0) return false;
+
+    // Writes go to explicit offsets, because appends would land in completion order
+    offset = append ? static_cast<uint64_t>(lseek(fd, 0, SEEK_END)) : 0;
+    if (directActive && offset % ALIGNMENT != 0) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+        directActive = false;
+    }
+    if (direct && !directActive) Metrics::increment("output.direct_unavailable");
+
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        blocks[i].data = static_cast<char*>(std::aligned_alloc(ALIGNMENT, blockSize));
+        if (!blocks[i].data) throw std::bad_alloc();
+        if (i > 0) freeBlocks.push_back(static_cast<int>(i));
+    }
+    current = 0;
+    setp(blocks[0].data, blocks[0].data + blockSize);
+
+#ifdef TPG_HAVE_IO_URING
+    ring = std::make_unique<Ring>();
+    if (!ring->setup(static_cast<unsigned>(blocks.size()))) ring.reset(); // kernels or sandboxes without io_uring
+#endif
+    if (ring) {
+        Metrics::increment("output.io_uring_files");
+    } else {
+        worker = std::thread(&AsyncStreamBuffer::writeLoop, this);
+        Metrics::increment("output.pwrite_files");
+    }
+    return true;
+}
+
+void AsyncStreamBuffer::finish() {
+    if (fd < 0 || finished) return;
+    finished = true;
+
+    // The tail is rarely a whole number of aligned sectors, so it goes through the page cache
+    if (directActive && (pptr() - pbase()) % ALIGNMENT != 0) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+        directActive = false;
+    }
+    submit();
+
+    if (ring) {
+        // Also after a failure: the kernel may still read from blocks that are in flight
+        while (inFlight > 0) {
+            if (!ring->reap(true, [this](int index, int result) { complete(index, result); })) {
+                std::lock_guard<std::mutex> lock(mutex);
+                error = "Unable to wait for io_uring completions";
+                break;
+            }
+        }
+    } else {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] { return inFlight == 0 || !error.empty(); });
+            stopping = true;
+        }
+        changed.notify_all();
+        worker.join();
+    }
+    ring.reset();
+
+    if (::close(fd) != 0 && error.empty()) error = "Unable to close output file";
+    fd = -1;
+    for (Block& block : blocks) std::free(block.data);
+    blocks.clear();
+    setp(nullptr, nullptr);
+
+    if (!error.empty()) throw std::runtime_error(error);
+}
+
+AsyncStreamBuffer::int_type AsyncStreamBuffer::overflow(int_type ch) {
+    submit();
+    if (hasError()) return traits_type::eof();
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+int AsyncStreamBuffer::sync() {
+    // A partial block would leave every later O_DIRECT write unaligned, so it waits to be filled
+    if (!directActive) submit();
+    if (ring) ring->reap(false, [this](int index, int result) { complete(index, result); });
+    return hasError() ? -1 : 0;
+}
+
+AsyncStreamBuffer::pos_type AsyncStreamBuffer::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) {
+    // Only reports the position, which includes the bytes still being written
+    if (off != 0 || dir != std::ios_base::cur || !(which & std::ios_base::out)) return pos_type(off_type(-1));
+    return pos_type(static_cast<off_type>(offset + (pptr() - pbase())));
+}
+
+bool AsyncStreamBuffer::hasError() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !error.empty();
+}
+
+void AsyncStreamBuffer::submit() {
+    const size_t size = pptr() - pbase();
+    if (size == 0 || current < 0) return;
+
+    Block& block = blocks[current];
+    block.size = size;
+    block.written = 0;
+    block.offset = offset;
+    offset += size;
+    write(current);
+
+    waitForBlock();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (freeBlocks.empty()) {
+        // Only after a failed write; the error is reported and output is discarded from here on
+        current = -1;
+        setp(nullptr, nullptr);
+        return;
+    }
+    current = freeBlocks.back();
+    freeBlocks.pop_back();
+    setp(blocks[current].data, blocks[current].data + blockSize);
+}
+
+void AsyncStreamBuffer::write(int index) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        inFlight++;
+        if (!ring) queue.push_back(index);
+    }
+    if (!ring) {
+        changed.notify_all();
+        return;
+    }
+    const Block& block = blocks[index];
+    if (!ring->push(fd, index, block.data + block.written, block.size - block.written, block.offset + block.written)) {
+        complete(index, -errno);
+    }
+}
+
+void AsyncStreamBuffer::complete(int index, ssize_t result) {
+    Block& block = blocks[index];
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        inFlight--;
+        if (result < 0 && result != -EINTR && result != -EAGAIN) {
+            if (error.empty()) error = std::string("Unable to write output file: ") + std::strerror(static_cast<int>(-result));
+        } else if (result > 0) {
+            block.written += result;
+        }
+    }
+
+    // Short and interrupted writes continue where they stopped
+    if (block.written < block.size && !hasError()) {
+        write(index);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        freeBlocks.push_back(index);
+    }
+    changed.notify_all();
+}
+
+void AsyncStreamBuffer::waitForBlock() {
+    if (ring) {
+        while (freeBlocks.empty() && !hasError()) {
+            if (!ring->reap(true, [this](int index, int result) { complete(index, result); })) {
+                std::lock_guard<std::mutex> lock(mutex);
+                error = "Unable to wait for io_uring completions";
+            }
+        }
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&] { return !freeBlocks.empty() || !error.empty(); });
+}
+
+void AsyncStreamBuffer::writeLoop() {
+    while (true) {
+        int index;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] { return !queue.empty() || stopping; });
+            if (queue.empty()) return;
+            index = queue.front();
+            queue.pop_front();
+        }
+
+        const Block& block = blocks[index];
+        ssize_t result = pwrite(fd, block.data + block.written, block.size - block.written, block.offset + block.written);
+        complete(index, result < 0 ? -errno : result);
+    }
+}
+
+ChecksumStreamBuffer::ChecksumStreamBuffer(std::streambuf* target) : target(target), block(BLOCK_SIZE) {
+    setp(block.data(), block.data() + block.size());
+}
+
+bool ChecksumStreamBuffer::pass() {
+    const std::streamsize size = pptr() - pbase();
+    if (size == 0) return true;
+    checksum = crc32(checksum, pbase(), static_cast<size_t>(size));
+    passed += static_cast<uint64_t>(size);
+    const bool written = target->sputn(pbase(), size) == size;
+    setp(block.data(), block.data() + block.size());
+    return written;
+}
+
+ChecksumStreamBuffer::int_type ChecksumStreamBuffer::overflow(int_type ch) {
+    if (!pass()) return traits_type::eof();
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+int ChecksumStreamBuffer::sync() {
+    if (!pass()) return -1;
+    return target->pubsync();
+}
+
+ChecksumStreamBuffer::pos_type ChecksumStreamBuffer::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) {
+    // Only reports the position: the target's, plus what is still buffered here
+    if (off != 0 || dir != std::ios_base::cur || !(which & std::ios_base::out)) return pos_type(off_type(-1));
+    const pos_type position = target->pubseekoff(0, std::ios_base::cur, std::ios_base::out);
+    if (position == pos_type(off_type(-1))) return position;
+    return position + static_cast<off_type>(pptr() - pbase());
+}
+
+OutputFile::~OutputFile() {
+    try {
+        close();
+    } catch (const std::exception& e) {
+        std::cerr << "Error closing output: " << e.what() << std::endl;
+    }
+}
+
+void OutputFile::open(const std::string& filename, std::ios::openmode mode) {
+    close();
+    if (compressionLevel > 0) {
+        auto gzip = std::make_unique<GzipStreamBuffer>(compressionLevel);
+        if (gzip->open(filename + ".gz", (mode & std::ios::app) != 0)) buffer = std::move(gzip);
+    } else if (asyncBlocks > 0) {
+        auto async = std::make_unique<AsyncStreamBuffer>(asyncBlockSize, asyncBlocks, asyncDirect);
+        if (async->open(filename, (mode & std::ios::app) != 0)) buffer = std::move(async);
+    } else {
+        auto file = std::make_unique<std::filebuf>();
+        if (file->open(filename, mode | std::ios::out)) buffer = std::move(file);
+    }
+
+    checksumBuffer.reset();
+    if (buffer && checksums) checksumBuffer = std::make_unique<ChecksumStreamBuffer>(buffer.get());
+    rdbuf(checksumBuffer ? static_cast<std::streambuf*>(checksumBuffer.get()) : buffer.get());
+    clear(buffer ? std::ios::goodbit : std::ios::failbit);
+}
+
+bool OutputFile::checksum(uint32_t& crc, uint64_t& size) const {
+    if (!checksumBuffer) return false;
+    crc = checksumBuffer->crc();
+    size = checksumBuffer->size();
+    return true;
+}
+
+void OutputFile::close() {
+    if (!buffer) return;
+    flush();
+    // A write that failed earlier only left the stream bad; the buffers report their own cause first
+    const bool failed = bad();
+
+    std::unique_ptr<std::streambuf> closing = std::move(buffer);
+    rdbuf(nullptr);
+    if (auto* gzip = dynamic_cast<GzipStreamBuffer*>(closing.get())) {
+        gzip->finish();
+    } else if (auto* async = dynamic_cast<AsyncStreamBuffer*>(closing.get())) {
+        async->finish();
+    } else if (!static_cast<std::filebuf*>(closing.get())->close()) {
+        throw std::runtime_error("Unable to close output file");
+    }
+    if (failed) throw std::runtime_error("Unable to write output file");
+}
+
+void OutputFile::setCompression(int level) {
+    compressionLevel = level;
+}
+
+int OutputFile::getCompression() {
+    return compressionLevel;
+}
+
+void OutputFile::setAsyncWrites(size_t blockSize, int blocks, bool direct) {
+    asyncBlockSize = blockSize;
+    asyncBlocks = blocks;
+    asyncDirect = direct;
+}
+
+void OutputFile::setChecksums(bool enabled) {
+    checksums = enabled;
+}
@@ -0,0 +1,357 @@
+#include "PairGenerator.h"
+#include "GeometryUtils.h"
+#include "TetrahedronFactory.h"
+#include "Metrics.h"
+
+PairGenerator::PairGenerator(const Configuration& config)
+    : PairGenerator(config.getDatasetSize(), config.getIntersectionDistribution(),
+                    config.getMinVolume(), config.getMaxVolume(), config.getNumBins()) {
+    configure(config);
+}
+
+void PairGenerator::configure(const Configuration& config) {
+    if (config.isShuffleEnabled()) {
+        setRandomSchedule(config.getShuffleSeed());
+    }
+    setBalancedSchedule(config.isTimeBudgetEnabled());
+    setGapOutput(config.isNearMissEnabled());
+    if (config.isContainmentEnabled()) {
+        setContainmentFeeder(config.getContainmentFromVolume(), config.getContainmentFraction());
+    }
+    if (config.isLabelShortcutEnabled()) {
+        setLabelShortcut(config.getLabelAuditRate());
+    }
+    if (config.isPrefilterEnabled()) {
+        std::vector<VolumeBounds::Stage> stages;
+        for (const auto& name : config.getPrefilterStages()) {
+            stages.push_back(VolumeBounds::parseStage(name));
+        }
+        setPrefilter(stages, config.getPrefilterTolerance());
+    }
+}
+
+PairGenerator::PairGenerator(int dataset_size, const std::vector<double>& distribution, double min_volume, double max_volume, int num_bins)
+    : dataset_size(dataset_size), min_volume(min_volume), max_volume(max_volume), num_bins(num_bins),
+      entries_per_type(distribution.size()), generated_per_type(distribution.size(), 0),
+      entries_per_bin(num_bins), volume_distribution(num_bins, 0) {
+
+    // Calculate entries per type
+    int remaining_entries = dataset_size;
+    for (size_t i = 0; i < distribution.size(); i++) {
+        entries_per_type[i] = static_cast<int>((distribution[i] / 100.0) * dataset_size);
+        remaining_entries -= entries_per_type[i];
+    }
+    entries_per_type[0] += remaining_entries;
+
+    // Uniform distribution of volume, remainder spread over the first bins so the quotas add up
+    for (int bin = 0; bin < num_bins; ++bin) {
+        entries_per_bin[bin] = entries_per_type[4] / num_bins + (bin < entries_per_type[4] % num_bins ? 1 : 0);
+    }
+}
+
+void PairGenerator::reset() {
+    generated = 0;
+    std::fill(generated_per_type.begin(), generated_per_type.end(), 0);
+    std::fill(volume_distribution.begin(), volume_distribution.end(), 0);
+    containment_generated = 0;
+    surplus = 0;
+}
+
+bool PairGenerator::resume(const PairRecord& record) {
+    // Count an existing record towards the quotas; records beyond a quota are surplus and count towards nothing
+    if (record.type < 1 || record.type > static_cast<int>(entries_per_type.size()) ||
+        generated_per_type[record.type - 1] >= entries_per_type[record.type - 1]) {
+        surplus++;
+        return false;
+    }
+
+    if (record.type == 5) {
+        if (record.volume < min_volume || record.volume > max_volume) {
+            surplus++;
+            return false;
+        }
+        int bin = volumeBin(record.volume);
+        if (volume_distribution[bin] >= entries_per_bin[bin]) {
+            surplus++;
+            return false;
+        }
+        volume_distribution[bin]++;
+    }
+
+    generated_per_type[record.type - 1]++;
+    generated++;
+    return true;
+}
+
+void PairGenerator::setContainmentFeeder(double from_volume, double fraction) {
+    containment_from_volume = from_volume;
+    containment_fraction = fraction;
+}
+
+void PairGenerator::setRandomSchedule(unsigned int seed) {
+    random_schedule = true;
+    schedule_generator.seed(seed);
+}
+
+void PairGenerator::setBalancedSchedule(bool enabled) {
+    balanced_schedule = enabled;
+}
+
+int PairGenerator::nextType() {
+    if (balanced_schedule) {
+        // The type furthest behind its share of the records generated so far, so every prefix
+        // of the output follows the distribution
+        int best = -1;
+        double best_deficit = 0.0;
+        for (size_t j = 0; j < entries_per_type.size(); j++) {
+            if (generated_per_type[j] >= entries_per_type[j]) continue;
+            double deficit = static_cast<double>(entries_per_type[j]) * (generated + 1) / dataset_size - generated_per_type[j];
+            if (best < 0 || deficit > best_deficit) {
+                best = j;
+                best_deficit = deficit;
+            }
+        }
+        if (best >= 0) return best + 1;
+    }
+
+    if (random_schedule) {
+        // Drawing proportionally to the remaining quotas yields a uniformly random order of types
+        std::uniform_int_distribution<int> pick(0, dataset_size - generated - 1);
+        int ticket = pick(schedule_generator);
+        for (size_t j = 0; j < entries_per_type.size(); j++) {
+            ticket -= entries_per_type[j] - generated_per_type[j];
+            if (ticket < 0) return j + 1;
+        }
+    }
+
+    // Find next type that needs more entries
+    for (size_t j = 0; j < entries_per_type.size(); j++) {
+        if (generated_per_type[j] < entries_per_type[j]) {
+            return j + 1;
+        }
+    }
+    throw std::runtime_error("All intersection types are complete");
+}
+
+int PairGenerator::volumeBin(double volume) const {
+    const auto size_of_interval = (max_volume - min_volume) / num_bins;
+    int bin = static_cast<int>((volume - min_volume) / size_of_interval);
+
+    // Clamp the bin to valid range
+    return std::min(std::max(bin, 0), num_bins - 1);
+}
+
+int PairGenerator::binLimit(int bin) const {
+    if (!balanced_schedule || entries_per_type[4] == 0) return entries_per_bin[bin];
+
+    // A bin may run at most one record ahead of its share of the type-5 records so far, so easy
+    // bins wait for hard ones; the allowances always leave some bin open
+    const int allowance = static_cast<int>(static_cast<int64_t>(entries_per_bin[bin]) * (generated_per_type[4] + 1) / entries_per_type[4]) + 1;
+    return std::min(entries_per_bin[bin], allowance);
+}
+
+void PairGenerator::setPrefilter(const std::vector<VolumeBounds::Stage>& stages, double tolerance) {
+    prefilter_stages = stages;
+    prefilter_tolerance = tolerance;
+}
+
+bool PairGenerator::hitsOpenBin(double lower, double upper) const {
+    if (upper < min_volume || lower > max_volume) return false;
+
+    for (int bin = volumeBin(std::max(lower, min_volume)); bin <= volumeBin(std::min(upper, max_volume)); ++bin) {
+        if (volume_distribution[bin] < binLimit(bin)) return true;
+    }
+    return false;
+}
+
+bool PairGenerator::passesPrefilter(const Tetrahedron& T1, const Tetrahedron& T2, const std::function<bool(double, double)>& reachable) const {
+    // Each stage narrows the interval; stop at the first one that leaves no wanted volume reachable
+    double lower = 0.0;
+    double upper = std::numeric_limits<double>::infinity();
+    for (const auto stage : prefilter_stages) {
+        VolumeBounds::Interval bound = VolumeBounds::compute(stage, T1, T2, prefilter_tolerance);
+        lower = std::max(lower, bound.lower);
+        upper = std::min(upper, bound.upper);
+        if (!reachable(lower, upper)) {
+            Metrics::increment("prefilter." + VolumeBounds::stageName(stage) + ".rejections");
+            return false;
+        }
+    }
+    Metrics::increment("prefilter.exact_computations");
+    return true;
+}
+
+void PairGenerator::setLabelShortcut(double audit_rate) {
+    label_shortcut = true;
+    label_audit_rate = audit_rate;
+    // Next to the counts, so the audited share can be read from the sidecar alone
+    Metrics::set("label_audit.rate", audit_rate);
+}
+
+bool PairGenerator::auditNext() {
+    // Audits are spread evenly: the n-th contact record is audited when audit_rate * n passes an integer
+    const uint64_t n = ++labelled;
+    return std::floor(label_audit_rate * n) > std::floor(label_audit_rate * (n - 1));
+}
+
+bool PairGenerator::feedNext() {
+    // Same spacing for the containment share of records generated per slice
+    const uint64_t n = ++fed;
+    return std::floor(containment_fraction * n) > std::floor(containment_fraction * (n - 1));
+}
+
+void PairGenerator::checkLabel(int type, bool intersection_status, double intersection_volume) const {
+    Metrics::increment("label_audit.audited");
+    if (intersection_status != (type != 1) || intersection_volume != 0.0) {
+        Metrics::increment("label_audit.mismatches");
+        Metrics::increment("label_audit.mismatches.type_" + std::to_string(type));
+    }
+}
+
+int PairGenerator::containmentBin() const {
+    // Keep the share of containment pairs among type-5 records at the configured fraction
+    if (containment_fraction <= 0 || containment_generated >= containment_fraction * (generated_per_type[4] + 1)) {
+        return -1;
+    }
+
+    // Feed the open bin at or above the threshold that is furthest from its quota
+    const auto size_of_interval = (max_volume - min_volume) / num_bins;
+    int best = -1;
+    for (int bin = 0; bin < num_bins; ++bin) {
+        if (min_volume + bin * size_of_interval < containment_from_volume) continue;
+        int remaining = binLimit(bin) - volume_distribution[bin];
+        if (remaining > 0 && (best < 0 || remaining > binLimit(best) - volume_distribution[best])) {
+            best = bin;
+        }
+    }
+    return best;
+}
+
+bool PairGenerator::buildCandidate(int type, int feeder_bin, const std::function<bool(double, double)>& reachable, PairRecord& record) {
+    std::pair<Tetrahedron, Tetrahedron> tetrahedron_pair;
+    bool intersection_status;
+    double intersection_volume;
+
+    if (feeder_bin >= 0) {
+        // One tetrahedron contains the other, so the overlap is the smaller volume and no Nef product is needed
+        const auto size_of_interval = (max_volume - min_volume) / num_bins;
+        tetrahedron_pair = TetrahedronFactory::ContainmentIntersection(
+            min_volume + feeder_bin * size_of_interval, min_volume + (feeder_bin + 1) * size_of_interval);
+        intersection_status = true;
+        intersection_volume = std::min(GeometryUtils::getVolume(tetrahedron_pair.first), GeometryUtils::getVolume(tetrahedron_pair.second));
+    } else {
+        tetrahedron_pair = TetrahedronFactory::createRandomTetrahedronPair(type);
+        if (type == 5 && !prefilter_stages.empty() && !passesPrefilter(tetrahedron_pair.first, tetrahedron_pair.second, reachable)) return false;
+
+        if (type < 5 && label_shortcut && !auditNext()) {
+            // The constructions fix the label: type 1 is disjoint, types 2-4 touch without common volume
+            intersection_status = type != 1;
+            intersection_volume = 0.0;
+        } else {
+            try {
+                intersection_status = GeometryUtils::checkIntersection(tetrahedron_pair.first, tetrahedron_pair.second);
+                intersection_volume = GeometryUtils::getIntersectionVolume(tetrahedron_pair.first, tetrahedron_pair.second);
+            } catch (const std::exception&) {
+                // A pair whose exact volume failed is counted and drawn again rather than labelled with a guess
+                Metrics::increment("exact_volume.failures");
+                return false;
+            }
+            if (type < 5 && label_shortcut) checkLabel(type, intersection_status, intersection_volume);
+        }
+    }
+
+    record = PairRecord{tetrahedron_pair.first, tetrahedron_pair.second, intersection_volume, intersection_status, type};
+    return true;
+}
+
+void PairGenerator::addGap(PairRecord& record) const {
+    if (gap_output && !record.intersects) {
+        record.gap = GeometryUtils::getDistance(record.T1, record.T2);
+    }
+}
+
+PairRecord PairGenerator::next() {
+    PairRecord record;
+    next(record, [] { return false; });
+    return record;
+}
+
+bool PairGenerator::next(PairRecord& record, const std::function<bool()>& stopped) {
+    const int type = nextType();
+    const auto reachable = [this](double lower, double upper) { return hitsOpenBin(lower, upper); };
+
+    while (true) {
+        // A nearly full bin can reject candidates for a long time, so a deadline is checked here
+        if (stopped()) return false;
+
+        const int feeder_bin = type == 5 ? containmentBin() : -1;
+        if (!buildCandidate(type, feeder_bin, reachable, record)) continue;
+
+        if (type == 5) {
+            // Discard entry if volume is out of range
+            if (record.volume < min_volume || record.volume > max_volume) continue;
+
+            // Discard entry if bin is full
+            int bin = volumeBin(record.volume);
+            if (volume_distribution[bin] >= binLimit(bin)) continue;
+
+            volume_distribution[bin]++;
+            if (feeder_bin >= 0) containment_generated++;
+        }
+
+        generated_per_type[type - 1]++;
+        generated++;
+
+        addGap(record);
+        return true;
+    }
+}
+
+PairRecord PairGenerator::generate(int type, int bin) {
+    PairRecord record;
+    generate(type, bin, record, [] { return false; });
+    return record;
+}
+
+bool PairGenerator::generate(int type, int bin, PairRecord& record, const std::function<bool()>& stopped) {
+    // Type-5 records must land in the slice's bin; the quotas themselves are left to the caller
+    const auto size_of_interval = (max_volume - min_volume) / num_bins;
+    const double bin_lower = min_volume + bin * size_of_interval;
+    const double bin_upper = bin_lower + size_of_interval;
+    const auto reachable = [&](double lower, double upper) { return upper >= bin_lower && lower <= bin_upper; };
+
+    // Whether this record comes from the containment feeder is decided once, not per candidate
+    const bool feed = type == 5 && containment_fraction > 0 && bin_lower >= containment_from_volume && feedNext();
+
+    while (true) {
+        if (stopped()) return false;
+        if (!buildCandidate(type, feed ? bin : -1, reachable, record)) continue;
+
+        if (type == 5 && (record.volume < min_volume || record.volume > max_volume || volumeBin(record.volume) != bin)) continue;
+
+        addGap(record);
+        return true;
+    }
+}
+
+std::vector<WorkSlice> PairGenerator::remainingSlices(int slice_size) const {
+    if (slice_size <= 0) {
+        throw std::invalid_argument("Slice size must be positive");
+    }
+
+    std::vector<WorkSlice> slices;
+    auto split = [&](int type, int bin, int count) {
+        for (; count > 0; count -= slice_size) {
+            slices.push_back(WorkSlice{type, bin, std::min(count, slice_size)});
+        }
+    };
+
+    // Types 1-4 are sliced per type, type 5 per volume bin, from whatever is still open
+    for (size_t j = 0; j + 1 < entries_per_type.size(); j++) {
+        split(j + 1, -1, entries_per_type[j] - generated_per_type[j]);
+    }
+    for (int bin = 0; bin < num_bins; ++bin) {
+        split(5, bin, entries_per_bin[bin] - volume_distribution[bin]);
+    }
+    return slices;
+}
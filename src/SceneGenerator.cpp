@@ -0,0 +1,205 @@
+#include "SceneGenerator.h"
+#include "GeometryUtils.h"
+#include "GridGeometry.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+static constexpr int CHUNK_SIZE = 64; // tetrahedra a worker claims at a time
+static constexpr double BOX_PADDING = 1e-12; // keeps touching tetrahedra in overlapping boxes
+
+static Tetrahedron fromCoordinates(const std::array<double, 12>& c) {
+    return Tetrahedron(Point(c[0], c[1], c[2]), Point(c[3], c[4], c[5]),
+                       Point(c[6], c[7], c[8]), Point(c[9], c[10], c[11]));
+}
+
+SceneGenerator::NarrowPhase SceneGenerator::parseNarrowPhase(const std::string& name) {
+    if (name == "exact") return Exact;
+    if (name == "estimate") return Estimate;
+    throw std::invalid_argument("Unknown narrow phase: " + name);
+}
+
+SceneGenerator::SceneGenerator(int tetrahedra, double scale, NarrowPhase narrow_phase, int threads)
+    : tetrahedra(tetrahedra), scale(scale), narrow_phase(narrow_phase), threads(threads) {
+    if (tetrahedra < 2) {
+        throw std::invalid_argument("A scene needs at least two tetrahedra");
+    }
+    if (!(scale > 0 && scale <= 1)) {
+        throw std::invalid_argument("Scene scale must be in (0, 1]");
+    }
+    if (threads <= 0) {
+        throw std::invalid_argument("Scene generation needs at least one thread");
+    }
+}
+
+Tetrahedron SceneGenerator::randomTetrahedron() const {
+    const int bits = GeometryUtils::getCoordinateGrid();
+
+    while (true) {
+        Tetrahedron T = GeometryUtils::generateRandomTetrahedron();
+        if (scale == 1.0) return T;
+
+        // A convex combination with a random point of the cube stays inside the cube
+        Point anchor = GeometryUtils::generateRandomPoint();
+        std::array<Point, 4> vertices;
+        for (int i = 0; i < 4; ++i) {
+            vertices[i] = Point(scale * CGAL::to_double(T.vertex(i).x()) + (1.0 - scale) * CGAL::to_double(anchor.x()),
+                                scale * CGAL::to_double(T.vertex(i).y()) + (1.0 - scale) * CGAL::to_double(anchor.y()),
+                                scale * CGAL::to_double(T.vertex(i).z()) + (1.0 - scale) * CGAL::to_double(anchor.z()));
+        }
+        Tetrahedron shrunk(vertices[0], vertices[1], vertices[2], vertices[3]);
+
+        if (bits > 0) {
+            GridGeometry::GridTetrahedron snapped = GridGeometry::snap(shrunk, bits);
+            if (GridGeometry::isDegenerate(snapped)) continue;
+            return GridGeometry::toTetrahedron(snapped, bits);
+        }
+        if (!shrunk.is_degenerate()) return shrunk;
+    }
+}
+
+Scene SceneGenerator::next() {
+    Scene scene;
+    std::vector<Coordinates> coordinates;
+    scene.tetrahedra.reserve(tetrahedra);
+    coordinates.reserve(tetrahedra);
+
+    // Drawn on the calling thread, so a scene depends only on the seed
+    for (int i = 0; i < tetrahedra; ++i) {
+        Tetrahedron T = randomTetrahedron();
+        Coordinates c;
+        for (int v = 0; v < 4; ++v) {
+            for (int k = 0; k < 3; ++k) {
+                c[3 * v + k] = CGAL::to_double(T.vertex(v)[k]);
+            }
+        }
+        scene.tetrahedra.push_back(T);
+        coordinates.push_back(c);
+    }
+
+    scene.edges = findEdges(coordinates);
+    Metrics::increment("scene.scenes");
+    Metrics::increment("scene.tetrahedra", tetrahedra);
+    Metrics::increment("scene.edges", scene.edges.size());
+    return scene;
+}
+
+std::vector<SceneEdge> SceneGenerator::findEdges(const std::vector<Coordinates>& coordinates) const {
+    const int n = static_cast<int>(coordinates.size());
+
+    std::vector<Box> boxes(n);
+    Box bounds = {std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+                  -std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+    double largest = 0.0;
+    for (int i = 0; i < n; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            double lower = std::min({coordinates[i][k], coordinates[i][3 + k], coordinates[i][6 + k], coordinates[i][9 + k]});
+            double upper = std::max({coordinates[i][k], coordinates[i][3 + k], coordinates[i][6 + k], coordinates[i][9 + k]});
+            boxes[i][k] = lower - BOX_PADDING;
+            boxes[i][3 + k] = upper + BOX_PADDING;
+            bounds[k] = std::min(bounds[k], boxes[i][k]);
+            bounds[3 + k] = std::max(bounds[3 + k], boxes[i][3 + k]);
+            largest = std::max(largest, boxes[i][3 + k] - boxes[i][k]);
+        }
+    }
+
+    // Cells about as wide as the largest box, so a box covers at most two cells per axis, with
+    // no more cells than a few per tetrahedron
+    double span = 0.0;
+    for (int k = 0; k < 3; ++k) span = std::max(span, bounds[3 + k] - bounds[k]);
+    const int max_cells = std::max(1, static_cast<int>(std::cbrt(8.0 * n)));
+    const int cells = std::clamp(static_cast<int>(span / largest), 1, max_cells);
+    const double cell_size = span / cells;
+
+    auto cellRange = [&](const Box& box, int k) {
+        int lower = static_cast<int>((box[k] - bounds[k]) / cell_size);
+        int upper = static_cast<int>((box[3 + k] - bounds[k]) / cell_size);
+        return std::make_pair(std::clamp(lower, 0, cells - 1), std::clamp(upper, 0, cells - 1));
+    };
+    auto forEachCell = [&](const Box& box, const std::function<void(size_t)>& visit) {
+        auto [x0, x1] = cellRange(box, 0);
+        auto [y0, y1] = cellRange(box, 1);
+        auto [z0, z1] = cellRange(box, 2);
+        for (int x = x0; x <= x1; ++x)
+            for (int y = y0; y <= y1; ++y)
+                for (int z = z0; z <= z1; ++z)
+                    visit((static_cast<size_t>(x) * cells + y) * cells + z);
+    };
+
+    // Cell contents in compressed rows: count, prefix sum, fill
+    std::vector<int> cell_start(static_cast<size_t>(cells) * cells * cells + 1, 0);
+    for (int i = 0; i < n; ++i) forEachCell(boxes[i], [&](size_t cell) { cell_start[cell + 1]++; });
+    for (size_t cell = 1; cell < cell_start.size(); ++cell) cell_start[cell] += cell_start[cell - 1];
+    std::vector<int> cell_items(cell_start.back());
+    std::vector<int> fill(cell_start.begin(), cell_start.end() - 1);
+    for (int i = 0; i < n; ++i) forEachCell(boxes[i], [&](size_t cell) { cell_items[fill[cell]++] = i; });
+
+    auto overlaps = [&](int i, int j) {
+        for (int k = 0; k < 3; ++k) {
+            if (boxes[i][3 + k] < boxes[j][k] || boxes[j][3 + k] < boxes[i][k]) return false;
+        }
+        return true;
+    };
+
+    std::atomic<int> next_index{0};
+    std::atomic<bool> failed{false};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    std::vector<std::vector<SceneEdge>> found(threads);
+
+    auto work = [&](int worker) {
+        try {
+            std::vector<int> candidates;
+            uint64_t candidate_pairs = 0;
+            for (int start = next_index.fetch_add(CHUNK_SIZE); start < n && !failed; start = next_index.fetch_add(CHUNK_SIZE)) {
+                for (int i = start; i < std::min(start + CHUNK_SIZE, n); ++i) {
+                    candidates.clear();
+                    forEachCell(boxes[i], [&](size_t cell) {
+                        for (int item = cell_start[cell]; item < cell_start[cell + 1]; ++item) {
+                            int j = cell_items[item];
+                            if (j > i && overlaps(i, j)) candidates.push_back(j);
+                        }
+                    });
+                    std::sort(candidates.begin(), candidates.end());
+                    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+                    candidate_pairs += candidates.size();
+
+                    // Exact objects are rebuilt on this thread instead of being shared between threads
+                    const Tetrahedron T1 = fromCoordinates(coordinates[i]);
+                    for (int j : candidates) {
+                        const Tetrahedron T2 = fromCoordinates(coordinates[j]);
+                        if (!GeometryUtils::checkIntersection(T1, T2)) continue;
+
+                        double volume = narrow_phase == Exact ? GeometryUtils::getIntersectionVolume(T1, T2)
+                                                              : GridGeometry::estimateIntersectionVolume(T1, T2);
+                        found[worker].push_back(SceneEdge{i, j, volume});
+                    }
+                }
+            }
+            Metrics::increment("scene.candidate_pairs", candidate_pairs);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) error = std::current_exception();
+            failed = true;
+        }
+    };
+
+    if (threads == 1) {
+        work(0);
+    } else {
+        std::vector<std::thread> pool;
+        for (int worker = 0; worker < threads; ++worker) pool.emplace_back(work, worker);
+        for (auto& thread : pool) thread.join();
+    }
+    if (error) std::rethrow_exception(error);
+
+    std::vector<SceneEdge> edges;
+    for (const auto& part : found) edges.insert(edges.end(), part.begin(), part.end());
+    std::sort(edges.begin(), edges.end(), [](const SceneEdge& a, const SceneEdge& b) {
+        return a.first != b.first ? a.first < b.first : a.second < b.second;
+    });
+    return edges;
+}
@@ -0,0 +1,50 @@
+#include "SceneWriter.h"
+
+SceneWriter::SceneWriter(const std::string& tetrahedraFilename, const std::string& pairsFilename, int prec) : precision(prec) {
+    tetrahedraFile.open(tetrahedraFilename);
+    if (!tetrahedraFile) {
+        throw std::runtime_error("Unable to open file: " + tetrahedraFilename);
+    }
+    pairsFile.open(pairsFilename);
+    if (!pairsFile) {
+        throw std::runtime_error("Unable to open file: " + pairsFilename);
+    }
+
+    tetrahedraFile << "Scene,Id";
+    for (int v = 1; v <= 4; ++v) {
+        tetrahedraFile << ",v" << v << "_x,v" << v << "_y,v" << v << "_z";
+    }
+    tetrahedraFile << "\n";
+    pairsFile << "Scene,First,Second,IntersectionVolume\n";
+
+    tetrahedraFile << std::fixed << std::setprecision(precision);
+    pairsFile << std::fixed << std::setprecision(precision);
+}
+
+SceneWriter::~SceneWriter() {
+    try {
+        close();
+    } catch (const std::exception& e) {
+        std::cerr << "Error closing scene output: " << e.what() << std::endl;
+    }
+}
+
+void SceneWriter::close() {
+    if (tetrahedraFile.is_open()) tetrahedraFile.close();
+    if (pairsFile.is_open()) pairsFile.close();
+}
+
+void SceneWriter::writeScene(int sceneId, const Scene& scene) {
+    for (size_t i = 0; i < scene.tetrahedra.size(); ++i) {
+        tetrahedraFile << sceneId << "," << i;
+        for (int v = 0; v < 4; ++v) {
+            const Point& p = scene.tetrahedra[i].vertex(v);
+            tetrahedraFile << "," << CGAL::to_double(p.x()) << "," << CGAL::to_double(p.y()) << "," << CGAL::to_double(p.z());
+        }
+        tetrahedraFile << "\n";
+    }
+
+    for (const auto& edge : scene.edges) {
+        pairsFile << sceneId << "," << edge.first << "," << edge.second << "," << edge.volume << "\n";
+    }
+}
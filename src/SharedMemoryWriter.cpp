@@ -0,0 +1,107 @@
+#include "SharedMemoryWriter.h"
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static constexpr int MAX_SPINS = 1000; // yields before a waiting producer starts to sleep
+
+SharedMemoryWriter::SharedMemoryWriter(const std::string& name, uint64_t capacity, bool drop_oldest, double timeout)
+    : name(name), timeout(timeout) {
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        throw std::invalid_argument("Shared memory capacity must be a power of two");
+    }
+
+    // Replace any segment left behind by a previous run; only the same user may attach
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        throw std::runtime_error("Unable to create shared memory: " + name);
+    }
+
+    mapped_size = sizeof(SharedMemoryRingHeader) + capacity * sizeof(SharedMemoryRecord);
+    if (ftruncate(fd, static_cast<off_t>(mapped_size)) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Unable to size shared memory: " + name);
+    }
+
+    void* memory = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        throw std::runtime_error("Unable to map shared memory: " + name);
+    }
+
+    // A fresh segment is zero-filled, so all slot sequences start out unpublished
+    ring = static_cast<SharedMemoryRingHeader*>(memory);
+    slots = reinterpret_cast<SharedMemoryRecord*>(static_cast<char*>(memory) + sizeof(SharedMemoryRingHeader));
+    std::memcpy(ring->magic, "TPGRING", 8);
+    ring->version = SHM_RING_VERSION;
+    ring->record_size = sizeof(SharedMemoryRecord);
+    ring->capacity = capacity;
+    ring->drop_oldest = drop_oldest ? 1 : 0;
+    ring->closed.store(0, std::memory_order_relaxed);
+    ring->head.store(0, std::memory_order_relaxed);
+    ring->tail.store(0, std::memory_order_release);
+}
+
+SharedMemoryWriter::~SharedMemoryWriter() {
+    if (ring != nullptr) {
+        // The segment stays alive for the consumer, which unlinks it when done
+        ring->closed.store(1, std::memory_order_release);
+        munmap(ring, mapped_size);
+    }
+}
+
+void SharedMemoryWriter::writeEntry(const Tetrahedron& T1, const Tetrahedron& T2, double volume, bool intersects) {
+    writeRecord({T1, T2, volume, intersects, 0});
+}
+
+void SharedMemoryWriter::writeRecord(const PairRecord& record) {
+    const uint64_t index = ring->head.load(std::memory_order_relaxed);
+
+    // Make room: wait for the consumer, or drop the oldest unread record
+    uint64_t waited_for = ring->tail.load(std::memory_order_acquire);
+    auto progress = std::chrono::steady_clock::now();
+    for (int spins = 0;; ++spins) {
+        uint64_t tail = ring->tail.load(std::memory_order_acquire);
+        if (index - tail < ring->capacity) break;
+
+        if (ring->drop_oldest) {
+            ring->tail.compare_exchange_weak(tail, tail + 1, std::memory_order_acq_rel);
+            continue;
+        }
+
+        // A consumer that reads nothing within the timeout is taken to be gone
+        const auto now = std::chrono::steady_clock::now();
+        if (tail != waited_for) {
+            waited_for = tail;
+            progress = now;
+        } else if (timeout > 0 && now - progress > std::chrono::duration<double>(timeout)) {
+            throw std::runtime_error("No consumer read from shared memory within the timeout: " + name);
+        }
+        if (spins < MAX_SPINS) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    SharedMemoryRecord& slot = slots[index & (ring->capacity - 1)];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (int i = 0; i < 4; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            slot.coordinates[3 * i + k] = CGAL::to_double(record.T1.vertex(i)[k]);
+            slot.coordinates[12 + 3 * i + k] = CGAL::to_double(record.T2.vertex(i)[k]);
+        }
+    }
+    slot.volume = record.volume;
+    slot.intersects = record.intersects ? 1 : 0;
+    slot.type = static_cast<uint32_t>(record.type);
+
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+    ring->head.store(index + 1, std::memory_order_release);
+}
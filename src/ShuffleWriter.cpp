@@ -0,0 +1,47 @@
+#include "ShuffleWriter.h"
+#include <algorithm>
+#include <iostream>
+
+ShuffleWriter::ShuffleWriter(std::unique_ptr<BaseWriter> writer, size_t bufferSize, unsigned int seed)
+    : writer(std::move(writer)), bufferSize(bufferSize), randomGenerator(seed) {
+    buffer.reserve(bufferSize + 1);
+}
+
+ShuffleWriter::~ShuffleWriter() {
+    // Owners close explicitly to see errors; this only catches records left by an early exit
+    if (buffer.empty()) return;
+    try {
+        flush();
+    } catch (const std::exception& e) {
+        std::cerr << "Shuffle buffer flush failed: " << e.what() << std::endl;
+    }
+}
+
+void ShuffleWriter::writeEntry(const Tetrahedron& T1, const Tetrahedron& T2, double volume, bool intersects) {
+    writeRecord({T1, T2, volume, intersects, 0});
+}
+
+void ShuffleWriter::writeRecord(const PairRecord& record) {
+    buffer.push_back(record);
+    if (buffer.size() <= bufferSize) return;
+
+    // Emit a random buffered record, the new one included
+    std::uniform_int_distribution<size_t> pick(0, buffer.size() - 1);
+    std::swap(buffer[pick(randomGenerator)], buffer.back());
+    writer->writeRecord(buffer.back());
+    buffer.pop_back();
+}
+
+void ShuffleWriter::close() {
+    flush();
+    writer->close();
+}
+
+void ShuffleWriter::flush() {
+    std::shuffle(buffer.begin(), buffer.end(), randomGenerator);
+    for (const auto& record : buffer) {
+        writer->writeRecord(record);
+    }
+    buffer.clear();
+    writer->flush();
+}
@@ -0,0 +1,107 @@
+#include "TetrahedronBatchGenerator.h"
+
+// Orientation determinant (six times the signed volume) of n tetrahedra stored as
+// structure-of-arrays; c holds x, y, z of vertices 0..3
+static void orientationDeterminants(const double* __restrict const* c, double* __restrict det, size_t n) {
+    const double* __restrict x0 = c[0]; const double* __restrict y0 = c[1]; const double* __restrict z0 = c[2];
+    const double* __restrict x1 = c[3]; const double* __restrict y1 = c[4]; const double* __restrict z1 = c[5];
+    const double* __restrict x2 = c[6]; const double* __restrict y2 = c[7]; const double* __restrict z2 = c[8];
+    const double* __restrict x3 = c[9]; const double* __restrict y3 = c[10]; const double* __restrict z3 = c[11];
+
+    for (size_t i = 0; i < n; ++i) {
+        double ax = x1[i] - x0[i], ay = y1[i] - y0[i], az = z1[i] - z0[i];
+        double bx = x2[i] - x0[i], by = y2[i] - y0[i], bz = z2[i] - z0[i];
+        double cx = x3[i] - x0[i], cy = y3[i] - y0[i], cz = z3[i] - z0[i];
+        det[i] = ax * (by * cz - bz * cy) - ay * (bx * cz - bz * cx) + az * (bx * cy - by * cx);
+    }
+}
+
+static void snapToGrid(double* __restrict values, size_t n, double cells, double cellSize) {
+    for (size_t i = 0; i < n; ++i) {
+        values[i] = std::floor(values[i] * cells) * cellSize;
+    }
+}
+
+TetrahedronBatchGenerator::TetrahedronBatchGenerator(uint64_t seed, size_t batchSize, double minAbsDeterminant, int gridBits)
+    : key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)},
+      batchSize(batchSize), minAbsDeterminant(std::max(minAbsDeterminant, DETERMINANT_ERROR_BOUND)), gridBits(gridBits) {
+    if (batchSize == 0) {
+        throw std::invalid_argument("Batch size must be greater than 0");
+    }
+    for (auto& axis : coordinates) axis.resize(batchSize);
+    determinants.resize(batchSize);
+    accepted.reserve(batchSize);
+}
+
+void TetrahedronBatchGenerator::generateCoordinates(size_t count) {
+    // Locals keep the compiler from assuming the output arrays alias the generator state
+    const uint64_t base = counter;
+    const uint32_t key0 = key[0], key1 = key[1];
+
+    // Each Philox block (tetrahedron index, block) yields 128 bits, i.e. two coordinates
+    for (uint32_t block = 0; block < 6; ++block) {
+        double* __restrict first = coordinates[2 * block].data();
+        double* __restrict second = coordinates[2 * block + 1].data();
+
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t index = base + i;
+            uint32_t c0 = static_cast<uint32_t>(index), c1 = static_cast<uint32_t>(index >> 32), c2 = block, c3 = 0;
+            uint32_t k0 = key0, k1 = key1;
+
+            for (int round = 0; round < 10; ++round) {
+                uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * c0;
+                uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * c2;
+                uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+                uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+                c1 = static_cast<uint32_t>(p1);
+                c3 = static_cast<uint32_t>(p0);
+                c0 = n0;
+                c2 = n2;
+                k0 += 0x9E3779B9u;
+                k1 += 0xBB67AE85u;
+            }
+
+            // 53 random bits per coordinate, uniform in [0, 1); signed conversion vectorizes on more targets
+            first[i] = static_cast<int64_t>((static_cast<uint64_t>(c0) << 21) ^ (c1 >> 11)) * 0x1.0p-53;
+            second[i] = static_cast<int64_t>((static_cast<uint64_t>(c2) << 21) ^ (c3 >> 11)) * 0x1.0p-53;
+        }
+    }
+    counter += count;
+
+    if (gridBits > 0) {
+        const double cells = std::ldexp(1.0, gridBits) + 1.0;
+        const double cellSize = std::ldexp(1.0, -gridBits);
+        for (auto& axis : coordinates) {
+            snapToGrid(axis.data(), count, cells, cellSize);
+        }
+    }
+}
+
+size_t TetrahedronBatchGenerator::fill() {
+    generateCoordinates(batchSize);
+
+    const double* axes[12];
+    for (int k = 0; k < 12; ++k) axes[k] = coordinates[k].data();
+    orientationDeterminants(axes, determinants.data(), batchSize);
+
+    accepted.clear();
+    nextAccepted = 0;
+    for (size_t i = 0; i < batchSize; ++i) {
+        if (std::abs(determinants[i]) > minAbsDeterminant) accepted.push_back(static_cast<uint32_t>(i));
+    }
+    return accepted.size();
+}
+
+Tetrahedron TetrahedronBatchGenerator::next() {
+    while (nextAccepted >= accepted.size()) {
+        fill();
+    }
+
+    const uint32_t i = accepted[nextAccepted++];
+    return Tetrahedron(
+        Point(coordinates[0][i], coordinates[1][i], coordinates[2][i]),
+        Point(coordinates[3][i], coordinates[4][i], coordinates[5][i]),
+        Point(coordinates[6][i], coordinates[7][i], coordinates[8][i]),
+        Point(coordinates[9][i], coordinates[10][i], coordinates[11][i])
+    );
+}
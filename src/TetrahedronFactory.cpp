@@ -1,13 +1,135 @@
 #include "TetrahedronFactory.h"
 #include <CGAL/Random.h>
 #include <CGAL/enum.h>
-#include <chrono>
+#include <algorithm>
 #include <cmath>
 #include <random>
 #include "GeometryUtils.h"
+#include "GridGeometry.h"
+#include "Metrics.h"
 #include <CGAL/point_generators_3.h>
 
-static CGAL::Random randomGenerator; // initialized once
+static thread_local std::mt19937 attemptGenerator(std::random_device{}()); // reseeded by setSeed for reproducible runs
+
+// Attempts allowed for one T1 before drawing a new one. The limit follows the number of
+// attempts successful T1s needed so far, so unlucky T1s are abandoned early on any machine.
+class AttemptBudget {
+public:
+    AttemptBudget(const std::string& name) : name(name) {}
+
+    int limit() const {
+        return std::clamp(static_cast<int>(MULTIPLIER * mean_attempts), MIN_ATTEMPTS, MAX_ATTEMPTS);
+    }
+
+    void recordSuccess(int attempts) {
+        mean_attempts += SMOOTHING * (attempts - mean_attempts);
+        Metrics::increment(name + ".attempts", attempts);
+        Metrics::increment(name + ".successes");
+    }
+
+    void recordGiveUp(int attempts) {
+        Metrics::increment(name + ".attempts", attempts);
+        Metrics::increment(name + ".give_ups");
+    }
+
+    void reset() { mean_attempts = INITIAL_MEAN; }
+    void swapMean(double& other) { std::swap(mean_attempts, other); }
+
+private:
+    static constexpr double INITIAL_MEAN = 250.0;
+    static constexpr double MULTIPLIER = 4.0; // a T1 at the mean success rate gives up with probability ~e^-4
+    static constexpr double SMOOTHING = 0.05;
+    static constexpr int MIN_ATTEMPTS = 100;
+    static constexpr int MAX_ATTEMPTS = 100000;
+
+    std::string name;
+    double mean_attempts = INITIAL_MEAN;
+};
+
+// Each thread adapts its own budgets, the same way it owns its random state
+static thread_local AttemptBudget pointBudget("point_intersection");
+static thread_local AttemptBudget lineBudget("line_intersection");
+static thread_local AttemptBudget polygonBudget("polygon_intersection");
+
+// Share of type-1 pairs built as near misses, and their target gap range
+static double nearMissFraction = 0.0;
+static double nearMissGapMin = 0.0;
+static double nearMissGapMax = 0.0;
+
+void TetrahedronFactory::setNearMiss(double fraction, double gap_min, double gap_max) {
+    nearMissFraction = fraction;
+    nearMissGapMin = gap_min;
+    nearMissGapMax = gap_max;
+}
+
+typedef std::array<std::array<double, 3>, 4> Coordinates;
+
+static Coordinates toCoordinates(const Tetrahedron& T) {
+    Coordinates v;
+    for (int i = 0; i < 4; ++i) {
+        for (int k = 0; k < 3; ++k) v[i][k] = CGAL::to_double(T.vertex(i)[k]);
+    }
+    return v;
+}
+
+// Uniform point inside a tetrahedron: the spacings of three sorted uniforms are uniform barycentric coordinates
+static std::array<double, 3> randomPointInside(const Coordinates& v, std::mt19937& gen) {
+    std::uniform_real_distribution<> unit(0.0, 1.0);
+    std::array<double, 3> u = {unit(gen), unit(gen), unit(gen)};
+    std::sort(u.begin(), u.end());
+    const double weights[4] = {u[0], u[1] - u[0], u[2] - u[1], 1.0 - u[2]};
+
+    std::array<double, 3> p = {0.0, 0.0, 0.0};
+    for (int i = 0; i < 4; ++i) {
+        for (int k = 0; k < 3; ++k) p[k] += weights[i] * v[i][k];
+    }
+    return p;
+}
+
+// A tetrahedron of at least the given volume. Random tetrahedra rarely exceed a few percent of
+// the cube, so large containers come from jittering the corners of a cube-inscribed tetrahedron.
+static Coordinates containerTetrahedron(double volume, std::mt19937& gen) {
+    static constexpr int RANDOM_SAMPLES = 64;
+    for (int i = 0; i < RANDOM_SAMPLES; ++i) {
+        Coordinates v = toCoordinates(GeometryUtils::generateRandomTetrahedron());
+        if (GeometryUtils::approximateVolume(v) >= volume) return v;
+    }
+
+    static constexpr int CORNERS[2][4][3] = {
+        {{0, 0, 0}, {1, 1, 0}, {1, 0, 1}, {0, 1, 1}},
+        {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {1, 1, 1}}
+    };
+    std::uniform_real_distribution<> unit(0.0, 1.0);
+    double slack = 0.5;
+    while (true) {
+        const auto& corners = CORNERS[unit(gen) < 0.5 ? 0 : 1];
+        Coordinates v;
+        for (int i = 0; i < 4; ++i) {
+            for (int k = 0; k < 3; ++k) {
+                double inset = slack * unit(gen);
+                v[i][k] = corners[i][k] == 0 ? inset : 1.0 - inset;
+            }
+        }
+        if (GeometryUtils::approximateVolume(v) >= volume) return v;
+        slack *= 0.9;
+    }
+}
+
+void TetrahedronFactory::setSeed(unsigned int seed) {
+    attemptGenerator.seed(seed);
+    pointBudget.reset();
+    lineBudget.reset();
+    polygonBudget.reset();
+    GeometryUtils::setSeed(seed);
+}
+
+void TetrahedronFactory::swapRandomState(RandomState& state) {
+    std::swap(attemptGenerator, state.attempts);
+    pointBudget.swapMean(state.budgets[0]);
+    lineBudget.swapMean(state.budgets[1]);
+    polygonBudget.swapMean(state.budgets[2]);
+    GeometryUtils::swapRandomState(state.geometry);
+}
 
 std::pair<Tetrahedron, Tetrahedron> TetrahedronFactory::createRandomTetrahedronPair() {
 
@@ -19,11 +141,14 @@ std::pair<Tetrahedron, Tetrahedron> TetrahedronFactory::createRandomTetrahedronP
 
 std::pair<Tetrahedron, Tetrahedron> TetrahedronFactory::createRandomTetrahedronPair(int type) {
     if (type == 0) {
-        type = rand() % 5 + 1;
+        type = std::uniform_int_distribution<int>(1, 5)(attemptGenerator);
     }
 
     switch (type) {
         case 1:
+            if (nearMissFraction > 0 && std::uniform_real_distribution<>(0.0, 1.0)(attemptGenerator) < nearMissFraction) {
+                return NearMissIntersection();
+            }
             return NoIntersection();
         case 2:
             return PointIntersection();
@@ -46,20 +171,136 @@ std::pair<Tetrahedron, Tetrahedron> TetrahedronFactory::NoIntersection() { // No
         tetrahedron1 = GeometryUtils::generateRandomTetrahedron();
         tetrahedron2 = GeometryUtils::generateRandomTetrahedron();
 
-    } while (CGAL::do_intersect(tetrahedron1, tetrahedron2));
+    } while (GeometryUtils::checkIntersection(tetrahedron1, tetrahedron2));
 
     return std::make_pair(tetrahedron1, tetrahedron2);
 }
 
+std::pair<Tetrahedron, Tetrahedron> TetrahedronFactory::NearMissIntersection() { // Separated by a small gap
+    Tetrahedron tetrahedron1, tetrahedron2;
+    std::mt19937& gen = attemptGenerator;
+
+    std::uniform_real_distribution<> dist_gap(nearMissGapMin, nearMissGapMax);
+    std::uniform_int_distribution<> dist_face(0, 3);
+    std::uniform_real_distribution<> dist_theta(-(M_PI/2) + epsilon, (M_PI/2) - epsilon);
+    std::uniform_real_distribution<> dist_phi(-(M_PI/2) + epsilon, (M_PI/2) - epsilon);
+
+    while (true) {
+        // Generate the first tetrahedron T1 and pick one of its faces
+        tetrahedron1 = GeometryUtils::generateRandomTetrahedron();
+        int apex = dist_face(gen);
+        const Point& A = tetrahedron1.vertex(apex + 1);
+        const Point& B = tetrahedron1.vertex(apex + 2);
+        const Point& C = tetrahedron1.vertex(apex + 3);
+
+        // Ensure the normal points outward
+        Vector normal = CGAL::normal(A, B, C);
+        if (CGAL::to_double(normal * (tetrahedron1.vertex(apex) - A)) > 0) {
+            normal = -normal;
+        }
+        double length = std::sqrt(CGAL::to_double(normal.squared_length()));
+
+        // The closest vertex of T2 sits at the target gap above a point of the face
+        double gap = dist_gap(gen);
+        Point contact = GeometryUtils::generateRandomPointOnTriangle(A, B, C);
+        Point vertex1(
+            CGAL::to_double(contact.x()) + gap * CGAL::to_double(normal.x()) / length,
+            CGAL::to_double(contact.y()) + gap * CGAL::to_double(normal.y()) / length,
+            CGAL::to_double(contact.z()) + gap * CGAL::to_double(normal.z()) / length
+        );
+        bool inside_cube = true;
+        for (int k = 0; k < 3; ++k) {
+            if (vertex1[k] < 0 || vertex1[k] > 1) inside_cube = false;
+        }
+        if (!inside_cube) continue;
+
+        // The other vertices lie beyond the plane through vertex1 parallel to the face,
+        // so the slab between the two planes separates T1 and T2 by exactly the gap
+        GeometryUtils::CoordinateSystem coords(normal);
+        std::vector<Point> new_vertices = {vertex1};
+        for (int i = 0; i < 3; ++i) {
+            double theta = dist_theta(gen);
+            double phi = dist_phi(gen);
+            double r_max = coords.calculateMaxRadius(vertex1, theta, phi);
+            double r = std::uniform_real_distribution<>(epsilon, r_max)(gen);
+            new_vertices.push_back(coords.sphericalToGlobal(vertex1, r, theta, phi));
+        }
+
+        tetrahedron2 = Tetrahedron(new_vertices[0], new_vertices[1], new_vertices[2], new_vertices[3]);
+
+        // Rounding the constructed coordinates to doubles must not close the gap
+        if (!tetrahedron2.is_degenerate() && !GeometryUtils::checkIntersection(tetrahedron1, tetrahedron2)) {
+            return std::make_pair(tetrahedron1, tetrahedron2);
+        }
+    }
+}
+
+std::pair<Tetrahedron, Tetrahedron> TetrahedronFactory::ContainmentIntersection(double volume_min, double volume_max) { // One inside the other
+    std::mt19937& gen = attemptGenerator;
+    std::uniform_real_distribution<> unit(0.0, 1.0);
+    const int bits = GeometryUtils::getCoordinateGrid();
+
+    while (true) {
+        const double volume = volume_min + (volume_max - volume_min) * unit(gen);
+        Coordinates outer = containerTetrahedron(volume, gen);
+
+        // Inner vertices start near the outer ones and are pulled towards random interior points;
+        // the pull shrinks until the inner tetrahedron is still large enough for the target volume
+        Coordinates inner;
+        double pull = 1.0;
+        do {
+            for (int i = 0; i < 4; ++i) {
+                std::array<double, 3> p = randomPointInside(outer, gen);
+                double t = pull * unit(gen);
+                for (int k = 0; k < 3; ++k) inner[i][k] = (1.0 - t) * outer[i][k] + t * p[k];
+            }
+            pull *= 0.5;
+        } while (GeometryUtils::approximateVolume(inner) < volume);
+
+        // Scaling about an interior point keeps every vertex inside the outer tetrahedron
+        std::array<double, 3> center = randomPointInside(outer, gen);
+        double scale = std::cbrt(volume / GeometryUtils::approximateVolume(inner));
+        for (auto& vertex : inner) {
+            for (int k = 0; k < 3; ++k) vertex[k] = center[k] + scale * (vertex[k] - center[k]);
+        }
+
+        auto toTetrahedron = [](const Coordinates& v) {
+            return Tetrahedron(Point(v[0][0], v[0][1], v[0][2]), Point(v[1][0], v[1][1], v[1][2]),
+                               Point(v[2][0], v[2][1], v[2][2]), Point(v[3][0], v[3][1], v[3][2]));
+        };
+        Tetrahedron tetrahedron1 = toTetrahedron(outer);
+        Tetrahedron tetrahedron2 = toTetrahedron(inner);
+
+        // Rounding, or snapping to the grid, may push an inner vertex out; such pairs are redrawn
+        bool contained = true;
+        if (bits > 0) {
+            auto grid1 = GridGeometry::snap(tetrahedron1, bits);
+            auto grid2 = GridGeometry::snap(tetrahedron2, bits);
+            contained = !GridGeometry::isDegenerate(grid2) && GridGeometry::contains(grid1, grid2);
+            tetrahedron1 = GridGeometry::toTetrahedron(grid1, bits);
+            tetrahedron2 = GridGeometry::toTetrahedron(grid2, bits);
+        } else {
+            contained = !tetrahedron2.is_degenerate();
+            for (int i = 0; i < 4 && contained; ++i) {
+                contained = !tetrahedron1.has_on_unbounded_side(tetrahedron2.vertex(i));
+            }
+        }
+        if (!contained) {
+            Metrics::increment("containment.redraws");
+            continue;
+        }
+
+        Metrics::increment("containment.pairs");
+        if (unit(gen) < 0.5) std::swap(tetrahedron1, tetrahedron2);
+        return std::make_pair(tetrahedron1, tetrahedron2);
+    }
+}
+
 std::pair<Tetrahedron, Tetrahedron> TetrahedronFactory::PointIntersection() { // Point
     Point vertexA, vertexB, vertexC, vertexD;
     Tetrahedron tetrahedron1, tetrahedron2;
 
-    auto start_time = std::chrono::steady_clock::now();
-    constexpr std::chrono::seconds timeout(1);
-
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    std::mt19937& gen = attemptGenerator;
 
     while (true) {
 
@@ -84,14 +325,15 @@ std::pair<Tetrahedron, Tetrahedron> TetrahedronFactory::PointIntersection() { //
 
         GeometryUtils::CoordinateSystem coords(normal);
 
-        auto attempt_start_time = std::chrono::steady_clock::now();
+        const int budget = pointBudget.limit();
+        int attempt = 1;
         bool success = false;
 
         // Distribution for spherical coordinates
         std::uniform_real_distribution<> dist_theta(-(M_PI/2) + epsilon, (M_PI/2) - epsilon);
         std::uniform_real_distribution<> dist_phi(-(M_PI/2) + epsilon, (M_PI/2) - epsilon);
 
-        while (std::chrono::steady_clock::now() - attempt_start_time < timeout) {
+        for (; attempt <= budget; ++attempt) {
             std::vector<Point> new_vertices = {vertex1};
             bool valid_points = true;
 
@@ -133,18 +375,16 @@ std::pair<Tetrahedron, Tetrahedron> TetrahedronFactory::PointIntersection() { //
         }
 
         if (success) {
+            pointBudget.recordSuccess(attempt);
             return std::make_pair(tetrahedron1, tetrahedron2);
         }
+        pointBudget.recordGiveUp(budget);
     }
 }
 
 std::pair<Tetrahedron, Tetrahedron> TetrahedronFactory::LineIntersection() { // Line
     Tetrahedron tetrahedron1, tetrahedron2;
-    auto start_time = std::chrono::steady_clock::now();
-    constexpr std::chrono::seconds timeout(3);
-
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    std::mt19937& gen = attemptGenerator;
 
     while (true) {
         // Generate the first tetrahedron T1
@@ -183,7 +423,8 @@ std::pair<Tetrahedron, Tetrahedron> TetrahedronFactory::LineIntersection() { //
         // Setup coordinate system based on the normal
         GeometryUtils::CoordinateSystem coords(normal);
 
-        auto attempt_start_time = std::chrono::steady_clock::now();
+        const int budget = lineBudget.limit();
+        int attempt = 1;
         bool success = false;
 
         // Spherical coordinate distributions
@@ -191,7 +432,7 @@ std::pair<Tetrahedron, Tetrahedron> TetrahedronFactory::LineIntersection() { //
         std::uniform_real_distribution<> dist_phi(-(M_PI/2) + epsilon, (M_PI/2) - epsilon);
 
         // Attempt to generate a valid second tetrahedron
-        while (std::chrono::steady_clock::now() - attempt_start_time < timeout) {
+        for (; attempt <= budget; ++attempt) {
             bool valid_points = true;
             std::vector<Point> vertices;
             for(int i=0; i<2; i++){
@@ -238,18 +479,16 @@ std::pair<Tetrahedron, Tetrahedron> TetrahedronFactory::LineIntersection() { //
 
         // Return successful pair or continue searching
         if (success) {
+            lineBudget.recordSuccess(attempt);
             return std::make_pair(tetrahedron1, tetrahedron2);
         }
+        lineBudget.recordGiveUp(budget);
     }
 }
 
 std::pair<Tetrahedron, Tetrahedron> TetrahedronFactory::PolygonIntersection() { // Polygon
     Tetrahedron tetrahedron1, tetrahedron2;
-    auto start_time = std::chrono::steady_clock::now();
-    constexpr std::chrono::seconds timeout(1);
-
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    std::mt19937& gen = attemptGenerator;
 
     while (true) {
         // Generate the first tetrahedron T1
@@ -290,7 +529,8 @@ std::pair<Tetrahedron, Tetrahedron> TetrahedronFactory::PolygonIntersection() {
         // Setup coordinate system based on the normal
         GeometryUtils::CoordinateSystem coords(normal);
 
-        auto attempt_start_time = std::chrono::steady_clock::now();
+        const int budget = polygonBudget.limit();
+        int attempt = 1;
         bool success = false;
 
         // Spherical coordinate distributions
@@ -298,7 +538,7 @@ std::pair<Tetrahedron, Tetrahedron> TetrahedronFactory::PolygonIntersection() {
         std::uniform_real_distribution<> dist_phi(-(M_PI/2) + epsilon, (M_PI/2) - epsilon);
 
         // Attempt to generate a valid second tetrahedron
-        while (std::chrono::steady_clock::now() - attempt_start_time < timeout) {
+        for (; attempt <= budget; ++attempt) {
             // Generate spherical coordinates
             double theta = dist_theta(gen);
             double phi = dist_phi(gen);
@@ -335,8 +575,10 @@ std::pair<Tetrahedron, Tetrahedron> TetrahedronFactory::PolygonIntersection() {
 
         // Return successful pair or continue searching
         if (success) {
+            polygonBudget.recordSuccess(attempt);
             return std::make_pair(tetrahedron1, tetrahedron2);
         }
+        polygonBudget.recordGiveUp(budget);
     }
 }
 
@@ -349,7 +591,7 @@ std::pair<Tetrahedron, Tetrahedron> TetrahedronFactory::PolyhedronIntersection()
         tetrahedron1 = GeometryUtils::generateRandomTetrahedron();
         tetrahedron2 = GeometryUtils::generateRandomTetrahedron();
 
-    } while (! CGAL::do_intersect(tetrahedron1, tetrahedron2));
+    } while (! GeometryUtils::checkIntersection(tetrahedron1, tetrahedron2));
 
     return std::make_pair(tetrahedron1, tetrahedron2);
 }
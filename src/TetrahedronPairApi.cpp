@@ -0,0 +1,195 @@
+#include "TetrahedronPairApi.h"
+#include "PairGenerator.h"
+#include "GeometryUtils.h"
+#include "TetrahedronFactory.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <numeric>
+
+struct tpg_generator {
+    std::unique_ptr<PairGenerator> generator;
+    TetrahedronFactory::RandomState random; // swapped into the calling thread for each tpg_generate
+};
+
+// Lends a generator's random state to the calling thread for the lifetime of the guard, so each
+// generator continues its own stream whichever thread calls it, and the thread's state is kept
+class RandomStateGuard {
+public:
+    explicit RandomStateGuard(TetrahedronFactory::RandomState& state) : state(state) {
+        TetrahedronFactory::swapRandomState(state);
+    }
+    ~RandomStateGuard() { TetrahedronFactory::swapRandomState(state); }
+    RandomStateGuard(const RandomStateGuard&) = delete;
+    RandomStateGuard& operator=(const RandomStateGuard&) = delete;
+
+private:
+    TetrahedronFactory::RandomState& state;
+};
+
+// A fresh generator whose stream starts from seed
+static tpg_generator* newGenerator(std::unique_ptr<PairGenerator> pairs, unsigned int seed) {
+    auto generator = std::make_unique<tpg_generator>();
+    generator->generator = std::move(pairs);
+    {
+        RandomStateGuard guard(generator->random);
+        TetrahedronFactory::setSeed(seed);
+        generator->generator->setRandomSchedule(seed);
+    }
+    return generator.release();
+}
+
+static thread_local std::string lastError;
+
+// Geometry settings live in GeometryUtils and TetrahedronFactory for the whole process, so all
+// generators alive at the same time must share them
+struct GeometrySettings {
+    int gridBits = 0;
+    double nearMissFraction = 0.0;
+    double nearMissGapMin = 0.0;
+    double nearMissGapMax = 0.0;
+    size_t batchSize = 0;
+    double minAbsDeterminant = 0.0;
+
+    bool operator==(const GeometrySettings& other) const {
+        return gridBits == other.gridBits && nearMissFraction == other.nearMissFraction &&
+               nearMissGapMin == other.nearMissGapMin && nearMissGapMax == other.nearMissGapMax &&
+               batchSize == other.batchSize && minAbsDeterminant == other.minAbsDeterminant;
+    }
+};
+
+static std::mutex settingsMutex;
+static GeometrySettings activeSettings;
+static int liveGenerators = 0;
+
+// Applies the settings of a new generator, or checks them against those of the live ones
+static void acquireSettings(const GeometrySettings& settings) {
+    std::lock_guard<std::mutex> lock(settingsMutex);
+    if (liveGenerators > 0) {
+        if (!(settings == activeSettings)) {
+            throw std::invalid_argument("Generators in one process must share the coordinate_grid, near_miss and batch_generation settings");
+        }
+    } else {
+        GeometryUtils::setCoordinateGrid(settings.gridBits);
+        TetrahedronFactory::setNearMiss(settings.nearMissFraction, settings.nearMissGapMin, settings.nearMissGapMax);
+        GeometryUtils::setBatchGeneration(settings.batchSize, settings.minAbsDeterminant);
+        activeSettings = settings;
+    }
+    liveGenerators++;
+}
+
+static void releaseSettings() {
+    std::lock_guard<std::mutex> lock(settingsMutex);
+    liveGenerators--;
+}
+
+static void writeTetrahedron(const Tetrahedron& T, float* out) {
+    for (int i = 0; i < 4; ++i) {
+        Point p = T.vertex(i);
+        out[3 * i] = static_cast<float>(CGAL::to_double(p.x()));
+        out[3 * i + 1] = static_cast<float>(CGAL::to_double(p.y()));
+        out[3 * i + 2] = static_cast<float>(CGAL::to_double(p.z()));
+    }
+}
+
+int tpg_api_version(void) {
+    return TPG_API_VERSION;
+}
+
+tpg_generator* tpg_create(const char* config_path, unsigned int seed) {
+    try {
+        Configuration config(config_path);
+        GeometrySettings settings;
+        if (config.isGridEnabled()) {
+            settings.gridBits = config.getGridBits();
+        }
+        if (config.isNearMissEnabled()) {
+            settings.nearMissFraction = config.getNearMissFraction();
+            settings.nearMissGapMin = config.getNearMissGapMin();
+            settings.nearMissGapMax = config.getNearMissGapMax();
+        }
+        if (config.isBatchGenerationEnabled()) {
+            settings.batchSize = config.getBatchSize();
+            settings.minAbsDeterminant = config.getMinAbsDeterminant();
+        }
+        acquireSettings(settings);
+        try {
+            return newGenerator(std::make_unique<PairGenerator>(config), seed);
+        } catch (...) {
+            releaseSettings();
+            throw;
+        }
+    } catch (const std::exception& e) {
+        lastError = e.what();
+        return nullptr;
+    }
+}
+
+tpg_generator* tpg_create_with_params(const double* distribution, double volume_min, double volume_max,
+                                      int num_bins, int round_size, unsigned int seed) {
+    try {
+        if (distribution == nullptr || num_bins <= 0 || round_size <= 0 || volume_min < 0 || volume_min >= volume_max) {
+            throw std::invalid_argument("Invalid generator parameters");
+        }
+        std::vector<double> percentages(distribution, distribution + 5);
+        if (std::any_of(percentages.begin(), percentages.end(), [](double p) { return !(p >= 0); }) ||
+            std::abs(std::accumulate(percentages.begin(), percentages.end(), 0.0) - 100.0) > 1.0) {
+            throw std::invalid_argument("Distribution must have 5 non-negative percentages summing to 100");
+        }
+        // Every requested type needs a pair in each round, and polyhedron pairs one per volume bin
+        for (size_t i = 0; i < percentages.size(); ++i) {
+            const int quota = static_cast<int>((percentages[i] / 100.0) * round_size);
+            if (percentages[i] > 0 && quota < (i == 4 ? num_bins : 1)) {
+                throw std::invalid_argument("Round size " + std::to_string(round_size) + " is too small for the distribution");
+            }
+        }
+
+        acquireSettings(GeometrySettings());
+        try {
+            return newGenerator(std::make_unique<PairGenerator>(round_size, percentages, volume_min, volume_max, num_bins), seed);
+        } catch (...) {
+            releaseSettings();
+            throw;
+        }
+    } catch (const std::exception& e) {
+        lastError = e.what();
+        return nullptr;
+    }
+}
+
+int tpg_generate(tpg_generator* generator, int count, float* coordinates, float* volumes, float* intersects) {
+    if (generator == nullptr || coordinates == nullptr || count < 0) {
+        lastError = "Invalid arguments to tpg_generate";
+        return -1;
+    }
+
+    try {
+        RandomStateGuard guard(generator->random);
+        for (int i = 0; i < count; ++i) {
+            // Start a new round once the quotas are met, so the stream never ends
+            if (!generator->generator->hasNext()) {
+                generator->generator->reset();
+            }
+
+            PairRecord record = generator->generator->next();
+            writeTetrahedron(record.T1, coordinates + static_cast<size_t>(i) * TPG_FLOATS_PER_PAIR);
+            writeTetrahedron(record.T2, coordinates + static_cast<size_t>(i) * TPG_FLOATS_PER_PAIR + 12);
+            if (volumes != nullptr) volumes[i] = static_cast<float>(record.volume);
+            if (intersects != nullptr) intersects[i] = record.intersects ? 1.0f : 0.0f;
+        }
+    } catch (const std::exception& e) {
+        lastError = e.what();
+        return -1;
+    }
+    return count;
+}
+
+void tpg_destroy(tpg_generator* generator) {
+    if (generator == nullptr) return;
+    delete generator;
+    releaseSettings();
+}
+
+const char* tpg_last_error(void) {
+    return lastError.c_str();
+}
@@ -0,0 +1,44 @@
+#include "VolumeBounds.h"
+#include "GeometryUtils.h"
+#include <algorithm>
+#include <limits>
+
+VolumeBounds::Stage VolumeBounds::parseStage(const std::string& name) {
+    if (name == "volume") return Stage::Volume;
+    if (name == "bbox") return Stage::BoundingBox;
+    throw std::invalid_argument("Unknown pre-filter stage: " + name);
+}
+
+std::string VolumeBounds::stageName(Stage stage) {
+    switch (stage) {
+        case Stage::Volume: return "volume";
+        case Stage::BoundingBox: return "bbox";
+    }
+    return "";
+}
+
+VolumeBounds::Interval VolumeBounds::compute(Stage stage, const Tetrahedron& T1, const Tetrahedron& T2, double tolerance) {
+    switch (stage) {
+        case Stage::Volume: {
+            // The overlap is part of both tetrahedra
+            return {0.0, std::min(GeometryUtils::approximateVolume(T1), GeometryUtils::approximateVolume(T2)) + tolerance};
+        }
+        case Stage::BoundingBox: {
+            // ... and of the intersection of their bounding boxes
+            double volume = 1.0;
+            for (int k = 0; k < 3; ++k) {
+                double low1 = CGAL::to_double(T1.vertex(0)[k]), high1 = low1;
+                double low2 = CGAL::to_double(T2.vertex(0)[k]), high2 = low2;
+                for (int i = 1; i < 4; ++i) {
+                    low1 = std::min(low1, CGAL::to_double(T1.vertex(i)[k]));
+                    high1 = std::max(high1, CGAL::to_double(T1.vertex(i)[k]));
+                    low2 = std::min(low2, CGAL::to_double(T2.vertex(i)[k]));
+                    high2 = std::max(high2, CGAL::to_double(T2.vertex(i)[k]));
+                }
+                volume *= std::max(0.0, std::min(high1, high2) - std::max(low1, low2));
+            }
+            return {0.0, volume + tolerance};
+        }
+    }
+    return {0.0, std::numeric_limits<double>::infinity()};
+}
@@ -0,0 +1,124 @@
+#include "WorkStealingScheduler.h"
+#include "Metrics.h"
+#include <thread>
+
+WorkStealingScheduler::WorkStealingScheduler(int threads) : threads(threads) {
+    if (threads <= 0) {
+        throw std::invalid_argument("Scheduler needs at least one thread");
+    }
+}
+
+void WorkStealingScheduler::run(const std::vector<WorkSlice>& slices, const InitFunction& init, const ProduceFunction& produce, const ConsumeFunction& consume) {
+    workers.clear();
+    for (int i = 0; i < threads; ++i) workers.push_back(std::make_unique<Worker>());
+
+    // Deal the slices round-robin; stealing evens out whatever this gets wrong
+    remaining = 0;
+    for (size_t i = 0; i < slices.size(); ++i) {
+        if (slices[i].count <= 0) continue;
+        workers[i % threads]->slices.push_back(slices[i]);
+        remaining += slices[i].count;
+    }
+    idle = 0;
+    failed = false;
+    error = nullptr;
+    handOffs = 0;
+
+    std::vector<std::thread> pool;
+    for (int i = 0; i < threads; ++i) {
+        pool.emplace_back(&WorkStealingScheduler::work, this, i, std::cref(init), std::cref(produce), std::cref(consume));
+    }
+    for (auto& thread : pool) thread.join();
+
+    if (error) std::rethrow_exception(error);
+}
+
+void WorkStealingScheduler::work(int index, const InitFunction& init, const ProduceFunction& produce, const ConsumeFunction& consume) {
+    try {
+        init(index);
+
+        while (!failed) {
+            WorkSlice slice;
+            if (!take(index, slice)) {
+                idle++;
+                bool found = false;
+                while (true) {
+                    uint64_t seen;
+                    {
+                        std::lock_guard<std::mutex> lock(idleMutex);
+                        seen = handOffs;
+                    }
+                    found = steal(index, slice);
+                    if (found || remaining == 0 || failed) break;
+
+                    // Nothing to steal: sleep until a slice is handed off or the work is done
+                    std::unique_lock<std::mutex> lock(idleMutex);
+                    workAvailable.wait(lock, [&] { return handOffs != seen || remaining == 0 || failed; });
+                }
+                idle--;
+                if (!found) return;
+            }
+
+            while (slice.count > 0 && !failed) {
+                // Someone is waiting for work: give away half of what is left of this slice
+                if (slice.count > 1 && idle > 0) {
+                    WorkSlice half{slice.type, slice.bin, slice.count / 2};
+                    slice.count -= half.count;
+                    {
+                        std::lock_guard<std::mutex> lock(workers[index]->mutex);
+                        workers[index]->slices.push_back(half);
+                    }
+                    wakeIdle(false);
+                    Metrics::increment("scheduler.splits");
+                }
+
+                PairRecord record = produce(slice);
+                {
+                    std::lock_guard<std::mutex> lock(consumeMutex);
+                    consume(record);
+                }
+                slice.count--;
+                if (--remaining == 0) wakeIdle(true);
+            }
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error) error = std::current_exception();
+        failed = true;
+        wakeIdle(true);
+    }
+}
+
+void WorkStealingScheduler::wakeIdle(bool all) {
+    // Changing the count under the mutex means a worker about to wait sees the change or the signal
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        handOffs++;
+    }
+    if (all) {
+        workAvailable.notify_all();
+    } else {
+        workAvailable.notify_one();
+    }
+}
+
+bool WorkStealingScheduler::take(int index, WorkSlice& slice) {
+    std::lock_guard<std::mutex> lock(workers[index]->mutex);
+    if (workers[index]->slices.empty()) return false;
+    slice = workers[index]->slices.back();
+    workers[index]->slices.pop_back();
+    return true;
+}
+
+bool WorkStealingScheduler::steal(int index, WorkSlice& slice) {
+    for (int offset = 1; offset < threads; ++offset) {
+        Worker& victim = *workers[(index + offset) % threads];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.slices.empty()) continue;
+        slice = victim.slices.front();
+        victim.slices.pop_front();
+        Metrics::increment("scheduler.steals");
+        return true;
+    }
+    return false;
+}
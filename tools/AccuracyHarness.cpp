@@ -0,0 +1,282 @@
+// Differential accuracy harness: measures the fast geometry backends against the exact
+// Epeck/Nef path of GeometryUtils on random and constructed pairs, and writes one report.
+//
+//   AccuracyHarness [--pairs N] [--threads N] [--seed N] [--grid-bits N] [--output FILE]
+//
+// Pairs cycle through fully random pairs and the five factory strategies; type-1 pairs are
+// half near misses with gaps down to 1e-12, and types 2-4 are the near-degenerate contacts.
+// Backends:
+//   estimate      double-precision clip volume; label is volume > 0
+//   grid          integer predicates and volume on the pair snapped to the grid; the reference
+//                 is the exact path on the same snapped pair
+//   construction  label and type taken from the strategy (types 1-4), as label_shortcut does
+//   bounds.*      each VolumeBounds stage; an error is a reference volume outside the interval
+
+#include "GeometryUtils.h"
+#include "GridGeometry.h"
+#include "TetrahedronFactory.h"
+#include "VolumeBounds.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+
+static const std::vector<std::string> SOURCES = {"random", "type_1", "type_2", "type_3", "type_4", "type_5"};
+static constexpr int CHUNK_SIZE = 64;
+static constexpr double BOUND_SLACK = 1e-12;
+
+typedef std::chrono::steady_clock Clock;
+
+static double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Error and agreement of one backend against the reference, mergeable across workers
+struct BackendStats {
+    std::vector<double> volume_errors;   // absolute
+    std::vector<double> relative_errors; // where the reference volume is positive
+    uint64_t compared = 0;
+    uint64_t false_positives = 0;
+    uint64_t false_negatives = 0;
+    uint64_t skipped = 0;
+    double seconds = 0.0;
+    double reference_seconds = 0.0;
+    std::map<std::string, uint64_t> disagreements_by_source;
+
+    void add(const std::string& source, double error, double reference_volume, bool label, bool reference_label) {
+        compared++;
+        volume_errors.push_back(error);
+        if (reference_volume > 0) relative_errors.push_back(error / reference_volume);
+        if (label != reference_label) {
+            (label ? false_positives : false_negatives)++;
+            disagreements_by_source[source]++;
+        }
+    }
+
+    void merge(const BackendStats& other) {
+        volume_errors.insert(volume_errors.end(), other.volume_errors.begin(), other.volume_errors.end());
+        relative_errors.insert(relative_errors.end(), other.relative_errors.begin(), other.relative_errors.end());
+        compared += other.compared;
+        false_positives += other.false_positives;
+        false_negatives += other.false_negatives;
+        skipped += other.skipped;
+        seconds += other.seconds;
+        reference_seconds += other.reference_seconds;
+        for (const auto& [source, count] : other.disagreements_by_source) disagreements_by_source[source] += count;
+    }
+};
+
+static json summarize(std::vector<double> values) {
+    json result;
+    result["count"] = values.size();
+    if (values.empty()) return result;
+    std::sort(values.begin(), values.end());
+    auto percentile = [&](double q) { return values[static_cast<size_t>(q * (values.size() - 1))]; };
+    double sum = 0.0;
+    for (double v : values) sum += v;
+    result["mean"] = sum / values.size();
+    result["p50"] = percentile(0.5);
+    result["p90"] = percentile(0.9);
+    result["p99"] = percentile(0.99);
+    result["p999"] = percentile(0.999);
+    result["max"] = values.back();
+    return result;
+}
+
+static json report(const BackendStats& stats) {
+    json result;
+    result["compared"] = stats.compared;
+    result["skipped"] = stats.skipped;
+    result["absolute_volume_error"] = summarize(stats.volume_errors);
+    result["relative_volume_error"] = summarize(stats.relative_errors);
+    result["label_disagreement_rate"] = stats.compared ? double(stats.false_positives + stats.false_negatives) / stats.compared : 0.0;
+    result["false_positives"] = stats.false_positives;
+    result["false_negatives"] = stats.false_negatives;
+    result["disagreements_by_source"] = stats.disagreements_by_source;
+    result["seconds"] = stats.seconds;
+    result["reference_seconds"] = stats.reference_seconds;
+    result["speedup"] = stats.seconds > 0 ? stats.reference_seconds / stats.seconds : 0.0;
+    return result;
+}
+
+struct WorkerStats {
+    BackendStats estimate;
+    BackendStats grid;
+    BackendStats construction;
+    std::map<std::string, BackendStats> bounds;
+    std::array<std::array<uint64_t, 5>, 5> construction_types{}; // [constructed][exact classification]
+    uint64_t pairs = 0;
+    uint64_t reference_failures = 0;
+    double reference_seconds = 0.0;
+
+    void merge(const WorkerStats& other) {
+        estimate.merge(other.estimate);
+        grid.merge(other.grid);
+        construction.merge(other.construction);
+        for (const auto& [name, stats] : other.bounds) bounds[name].merge(stats);
+        for (int i = 0; i < 5; ++i)
+            for (int j = 0; j < 5; ++j) construction_types[i][j] += other.construction_types[i][j];
+        pairs += other.pairs;
+        reference_failures += other.reference_failures;
+        reference_seconds += other.reference_seconds;
+    }
+};
+
+static void comparePair(int source, const std::pair<Tetrahedron, Tetrahedron>& pair, int grid_bits, WorkerStats& stats) {
+    const Tetrahedron& T1 = pair.first;
+    const Tetrahedron& T2 = pair.second;
+    const std::string& name = SOURCES[source];
+
+    // Exact reference
+    Clock::time_point start = Clock::now();
+    const bool reference_intersects = GeometryUtils::checkIntersection(T1, T2);
+    const double reference_intersection_seconds = secondsSince(start);
+    start = Clock::now();
+    const double reference_volume = GeometryUtils::getIntersectionVolume(T1, T2);
+    const double reference_volume_seconds = secondsSince(start);
+    stats.reference_seconds += reference_intersection_seconds + reference_volume_seconds;
+
+    start = Clock::now();
+    const double estimate = GridGeometry::estimateIntersectionVolume(T1, T2);
+    stats.estimate.seconds += secondsSince(start);
+    stats.estimate.reference_seconds += reference_volume_seconds;
+    stats.estimate.add(name, std::abs(estimate - reference_volume), reference_volume, estimate > 0, reference_volume > 0);
+
+    for (const auto stage : {VolumeBounds::Stage::Volume, VolumeBounds::Stage::BoundingBox}) {
+        BackendStats& bound_stats = stats.bounds[VolumeBounds::stageName(stage)];
+        start = Clock::now();
+        VolumeBounds::Interval bound = VolumeBounds::compute(stage, T1, T2, 1e-9);
+        bound_stats.seconds += secondsSince(start);
+        bound_stats.reference_seconds += reference_volume_seconds;
+        const bool inside = reference_volume >= bound.lower - BOUND_SLACK && reference_volume <= bound.upper + BOUND_SLACK;
+        const double error = inside ? 0.0 : std::max(bound.lower - reference_volume, reference_volume - bound.upper);
+        // A violated bound counts as a false positive, so the disagreement rate is the violation rate
+        bound_stats.add(name, error, reference_volume, !inside, false);
+    }
+
+    // Contact strategies: the label the construction promises against the exact classification
+    if (source >= 1 && source <= 4) {
+        start = Clock::now();
+        const int exact_type = static_cast<int>(GeometryUtils::getIntersectionClassification(T1, T2));
+        stats.construction.reference_seconds += secondsSince(start);
+        stats.construction_types[source - 1][exact_type]++;
+        stats.construction.add(name, reference_volume, reference_volume, source != 1, reference_intersects);
+    }
+
+    const GridGeometry::GridTetrahedron G1 = GridGeometry::snap(T1, grid_bits);
+    const GridGeometry::GridTetrahedron G2 = GridGeometry::snap(T2, grid_bits);
+    if (GridGeometry::isDegenerate(G1) || GridGeometry::isDegenerate(G2)) {
+        stats.grid.skipped++;
+        return;
+    }
+    const Tetrahedron S1 = GridGeometry::toTetrahedron(G1, grid_bits);
+    const Tetrahedron S2 = GridGeometry::toTetrahedron(G2, grid_bits);
+    start = Clock::now();
+    const bool snapped_intersects = GeometryUtils::checkIntersection(S1, S2);
+    const double snapped_volume = GeometryUtils::getIntersectionVolume(S1, S2);
+    stats.grid.reference_seconds += secondsSince(start);
+    start = Clock::now();
+    const bool grid_intersects = GridGeometry::checkIntersection(G1, G2);
+    const double grid_volume = GridGeometry::getIntersectionVolume(G1, G2, grid_bits);
+    stats.grid.seconds += secondsSince(start);
+    stats.grid.add(name, std::abs(grid_volume - snapped_volume), snapped_volume, grid_intersects, snapped_intersects);
+}
+
+int main(int argc, char** argv) {
+    long long pairs = 1000000;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int seed = 1;
+    int grid_bits = 16;
+    std::string output = "../output/accuracy_report.json";
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--pairs") pairs = std::stoll(argv[i + 1]);
+        else if (option == "--threads") threads = std::stoi(argv[i + 1]);
+        else if (option == "--seed") seed = static_cast<unsigned int>(std::stoul(argv[i + 1]));
+        else if (option == "--grid-bits") grid_bits = std::stoi(argv[i + 1]);
+        else if (option == "--output") output = argv[i + 1];
+        else {
+            std::cerr << "Unknown option: " << option << std::endl;
+            return 1;
+        }
+    }
+    if (pairs <= 0 || threads <= 0 || grid_bits < 1 || grid_bits > GridGeometry::MAX_BITS) {
+        std::cerr << "Invalid arguments" << std::endl;
+        return 1;
+    }
+
+    // Half of the disjoint pairs are near misses with gaps down to the limits of double precision
+    TetrahedronFactory::setNearMiss(0.5, 1e-12, 1e-6);
+
+    std::atomic<long long> next_index{0};
+    std::atomic<long long> done{0};
+    std::mutex merge_mutex;
+    WorkerStats total;
+    const Clock::time_point started = Clock::now();
+
+    auto work = [&](int worker) {
+        TetrahedronFactory::setSeed(seed + worker + 1);
+        WorkerStats stats;
+        for (long long start = next_index.fetch_add(CHUNK_SIZE); start < pairs; start = next_index.fetch_add(CHUNK_SIZE)) {
+            for (long long index = start; index < std::min(start + CHUNK_SIZE, pairs); ++index) {
+                const int source = static_cast<int>(index % SOURCES.size());
+                try {
+                    auto pair = source == 0 ? std::make_pair(GeometryUtils::generateRandomTetrahedron(), GeometryUtils::generateRandomTetrahedron())
+                                            : TetrahedronFactory::createRandomTetrahedronPair(source);
+                    comparePair(source, pair, grid_bits, stats);
+                    stats.pairs++;
+                } catch (const std::exception&) {
+                    stats.reference_failures++;
+                }
+                done++;
+            }
+        }
+        std::lock_guard<std::mutex> lock(merge_mutex);
+        total.merge(stats);
+    };
+
+    std::vector<std::thread> pool;
+    for (int worker = 0; worker < threads; ++worker) pool.emplace_back(work, worker);
+    while (done < pairs) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        std::cout << "\rCompared " << done << " / " << pairs << " pairs" << std::flush;
+    }
+    for (auto& thread : pool) thread.join();
+    std::cout << std::endl;
+
+    json result;
+    result["pairs"] = total.pairs;
+    result["reference_failures"] = total.reference_failures;
+    result["threads"] = threads;
+    result["seed"] = seed;
+    result["grid_bits"] = grid_bits;
+    result["wall_seconds"] = secondsSince(started);
+    result["reference_seconds"] = total.reference_seconds;
+    result["backends"]["estimate"] = report(total.estimate);
+    result["backends"]["grid"] = report(total.grid);
+    result["backends"]["construction"] = report(total.construction);
+    result["backends"]["construction"]["type_confusion"] = total.construction_types;
+    for (const auto& [name, stats] : total.bounds) {
+        result["backends"]["bounds." + name] = report(stats);
+    }
+
+    std::ofstream file(output);
+    if (!file) {
+        std::cerr << "Unable to open file: " << output << std::endl;
+        return 1;
+    }
+    file << result.dump(4) << std::endl;
+
+    for (const auto& [name, backend] : result["backends"].items()) {
+        std::cout << std::left << std::setw(20) << name
+                  << " max error " << std::setw(14) << backend["absolute_volume_error"].value("max", 0.0)
+                  << " p99 " << std::setw(14) << backend["absolute_volume_error"].value("p99", 0.0)
+                  << " disagreement " << std::setw(12) << backend["label_disagreement_rate"].get<double>()
+                  << " speedup " << backend["speedup"].get<double>() << std::endl;
+    }
+    std::cout << "Report written to " << output << std::endl;
+    return 0;
+}
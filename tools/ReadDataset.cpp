@@ -0,0 +1,94 @@
+// Loads a CSV dataset through MappedDataset and reports what was read; with --output the kept
+// rows are written as raw little-endian arrays that numpy.fromfile reads directly.
+//
+//   ReadDataset --input FILE [--threads N] [--types 1,5] [--volume-min X] [--volume-max X]
+//               [--output PREFIX]
+//
+// Output files: PREFIX.coordinates.f32 (rows x 24), PREFIX.volumes.f32, PREFIX.intersects.u8,
+// PREFIX.types.i8 and, for datasets with a Gap column, PREFIX.gaps.f32.
+
+#include "MappedDataset.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+template <typename T>
+static bool writeArray(const std::string& filename, const std::vector<T>& values) {
+    std::ofstream file(filename, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    if (!file) {
+        std::cerr << "Unable to write file: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::string input;
+    std::string output;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    DatasetFilter filter;
+
+    try {
+        for (int i = 1; i + 1 < argc; i += 2) {
+            std::string option = argv[i];
+            if (option == "--input") input = argv[i + 1];
+            else if (option == "--output") output = argv[i + 1];
+            else if (option == "--threads") threads = std::stoi(argv[i + 1]);
+            else if (option == "--volume-min") filter.volume_min = std::stod(argv[i + 1]);
+            else if (option == "--volume-max") filter.volume_max = std::stod(argv[i + 1]);
+            else if (option == "--types") {
+                std::stringstream list(argv[i + 1]);
+                std::string type;
+                while (std::getline(list, type, ',')) filter.types.push_back(std::stoi(type));
+            } else {
+                std::cerr << "Unknown option: " << option << std::endl;
+                return 1;
+            }
+        }
+    } catch (const std::exception&) {
+        std::cerr << "Invalid arguments" << std::endl;
+        return 1;
+    }
+    if (input.empty() || threads <= 0 || filter.volume_min > filter.volume_max) {
+        std::cerr << "Invalid arguments" << std::endl;
+        return 1;
+    }
+
+    try {
+        const auto started = std::chrono::steady_clock::now();
+        MappedDataset dataset(input);
+        DatasetColumns columns = dataset.read(filter, threads);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        std::array<size_t, 6> per_type{};
+        for (int8_t type : columns.types) {
+            if (type >= 0 && type <= 5) per_type[type]++;
+        }
+
+        std::cout << "Read " << columns.rows << " rows from " << input << " in " << seconds << " s ("
+                  << dataset.sizeBytes() / (1024.0 * 1024.0) / seconds << " MiB/s, "
+                  << columns.rows / seconds << " rows/s)" << std::endl;
+        for (int type = dataset.hasTypes() ? 1 : 0; type <= 5; ++type) {
+            std::cout << "  type " << type << (type == 0 ? " (contact, unknown)" : "") << ": " << per_type[type] << std::endl;
+        }
+
+        if (!output.empty()) {
+            bool written = writeArray(output + ".coordinates.f32", columns.coordinates)
+                        && writeArray(output + ".volumes.f32", columns.volumes)
+                        && writeArray(output + ".intersects.u8", columns.intersects)
+                        && writeArray(output + ".types.i8", columns.types)
+                        && (!dataset.hasGaps() || writeArray(output + ".gaps.f32", columns.gaps));
+            if (!written) return 1;
+            std::cout << "Arrays written to " << output << ".*" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}